@@ -0,0 +1,141 @@
+#include "PatternBenchmarks.hpp"
+#include "Trace.hpp"
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+// Example in C++ written by: Paul Burgess
+
+// Benchmark runner for the pattern examples (see PatternBenchmarks.hpp).
+// Build with Design-Patterns/ on the include path, optimizations on, e.g.
+//   g++ -std=c++20 -O2 -DNDEBUG -pthread -IDesign-Patterns Benchmarks/Benchmarks.cpp -o pattern_benchmarks
+
+// Options:
+//   --filter=<text>      only run benchmarks whose name contains <text>
+//   --json=<file>        also write the results as JSON ('-' for stdout)
+//   --min-time-ms=<n>    minimum time per repetition (default 100)
+//   --repetitions=<n>    repetitions per benchmark (default 5)
+//   --trace=<file>       write the recorded spans as a Chrome trace (needs a
+//                        build with DESIGN_PATTERNS_TRACE=1)
+//   --list               print the benchmark names and exit
+
+namespace {
+
+bool read_option(const std::string& argument, const std::string& option, std::string& value) {
+	const std::string prefix = "--" + option + "=";
+	if (argument.compare(0, prefix.size(), prefix) != 0) {
+		return false;
+	}
+	value = argument.substr(prefix.size());
+	return true;
+}
+
+void print_usage(std::ostream& out) {
+	out << "Usage: pattern_benchmarks [--filter=<text>] [--json=<file>|-] [--min-time-ms=<n>]\n"
+		<< "                          [--repetitions=<n>] [--trace=<file>] [--list]\n";
+}
+
+// Parses the value of 'argument' as a whole number in [0, max_count].  On bad
+// input ("abc", "12abc", "-1", larger than max_count) prints an error and the
+// usage and returns false.
+bool parse_count(const std::string& argument, const std::string& value, unsigned long long max_count, unsigned long long& count) {
+	try {
+		std::size_t parsed = 0;
+		if (!value.empty() && value.front() >= '0' && value.front() <= '9') {
+			count = std::stoull(value, &parsed);
+		}
+		if (parsed != 0 && parsed == value.size()) {
+			if (count <= max_count) {
+				return true;
+			}
+			std::cerr << "Number out of range in " << argument << " (at most " << max_count << ")\n";
+			print_usage(std::cerr);
+			return false;
+		}
+		std::cerr << "Invalid number in " << argument << "\n";
+	} catch (const std::invalid_argument&) {
+		std::cerr << "Invalid number in " << argument << "\n";
+	} catch (const std::out_of_range&) {
+		std::cerr << "Number out of range in " << argument << "\n";
+	}
+	print_usage(std::cerr);
+	return false;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+
+	BenchmarkSuite suite = make_pattern_benchmarks();
+	std::string filter;
+	std::string json_path;
+	std::string trace_path;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string argument = argv[i];
+		std::string value;
+		if (argument == "--list") {
+			for (const std::string& name : suite.get_names()) {
+				std::cout << name << "\n";
+			}
+			return 0;
+		} else if (read_option(argument, "filter", value)) {
+			filter = value;
+		} else if (read_option(argument, "json", value)) {
+			json_path = value;
+		} else if (read_option(argument, "trace", value)) {
+			trace_path = value;
+		} else if (read_option(argument, "min-time-ms", value)) {
+			// Must fit the signed count of std::chrono::milliseconds
+			unsigned long long milliseconds = 0;
+			if (!parse_count(argument, value, static_cast<unsigned long long>(std::chrono::milliseconds::max().count()), milliseconds)) {
+				return 1;
+			}
+			suite.set_min_time(std::chrono::milliseconds{ static_cast<std::chrono::milliseconds::rep>(milliseconds) });
+		} else if (read_option(argument, "repetitions", value)) {
+			unsigned long long repetitions = 0;
+			if (!parse_count(argument, value, std::numeric_limits<std::size_t>::max(), repetitions)) {
+				return 1;
+			}
+			suite.set_repetitions(static_cast<std::size_t>(repetitions));
+		} else {
+			std::cerr << "Unknown option: " << argument << "\n";
+			print_usage(std::cerr);
+			return 1;
+		}
+	}
+
+	const std::vector<BenchmarkResult> results = suite.run(filter);
+
+	if (!trace_path.empty()) {
+		if (!DESIGN_PATTERNS_TRACE) {
+			std::cerr << "Tracing is compiled out; rebuild with DESIGN_PATTERNS_TRACE=1\n";
+		}
+		std::ofstream trace_file{ trace_path };
+		if (!trace_file) {
+			std::cerr << "Could not open " << trace_path << "\n";
+			return 1;
+		}
+		write_chrome_trace(trace_file);
+	}
+
+	if (json_path == "-") {
+		write_benchmark_json(std::cout, results);
+		return 0;
+	}
+
+	write_benchmark_table(std::cout, results);
+	if (!json_path.empty()) {
+		std::ofstream json_file{ json_path };
+		if (!json_file) {
+			std::cerr << "Could not open " << json_path << "\n";
+			return 1;
+		}
+		write_benchmark_json(json_file, results);
+	}
+	return 0;
+}
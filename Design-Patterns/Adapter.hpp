@@ -1,5 +1,6 @@
 #pragma once
 #include "Print.hpp"
+#include "Trace.hpp"
 
 // Concept From: Head First Design Patterns
 // Example in C++ written by: Paul Burgess
@@ -58,10 +59,12 @@ public:
 	}
 
 	void quack() const override{
+		TRACE_SPAN("TurkeyToDuckAdapterClass::quack");
 		m_turkey->gobble();
 	}
 
 	void fly() const override{
+		TRACE_SPAN("TurkeyToDuckAdapterClass::fly");
 		m_turkey->fly();
 	}
 		
@@ -0,0 +1,248 @@
+#pragma once
+#include "Print.hpp"
+#include "Trace.hpp"
+#include "Adapter.hpp"
+#include "BenchmarkHarness.hpp"
+#include <chrono>
+#include <concepts>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Concept From: Head First Design Patterns
+// Example in C++ written by: Paul Burgess
+
+// Compile-Time Adapters
+// TurkeyToDuckAdapterClass (Adapter.hpp) is itself a DuckClass, so every
+// quack() goes through two vtables: DuckClass -> adapter -> TurkeyClass.
+// When the concrete turkey type is known at compile time, the adapter can be
+// a plain template instead.  Its calls resolve statically and usually inline
+// away, so test_duck() on an adapted turkey costs the same as calling the
+// turkey directly.
+
+// The client side uses a concept (DuckLike) instead of the DuckClass base
+// class.  Where a real DuckClass* is required (a type-erased boundary, e.g. a
+// container of mixed ducks), erase_duck() wraps any DuckLike in the virtual
+// interface.
+
+
+// ---------- Concepts ----------
+// This is what you need to adapt "TO"
+template <typename T>
+concept DuckLike = requires(const T& duck) {
+	duck.quack();
+	duck.fly();
+};
+
+// The "adaptee"
+template <typename T>
+concept TurkeyLike = requires(T& turkey) {
+	turkey.gobble();
+	turkey.fly();
+};
+
+
+// ---------- Adapter ----------
+// Holds a pointer to the concrete turkey type.  Nothing is virtual here; if the
+// turkey type is final (or not polymorphic at all) the calls are direct.
+template <TurkeyLike Turkey>
+class TurkeyToDuckAdapter {
+public:
+	explicit TurkeyToDuckAdapter(Turkey& turkey)
+		:m_turkey{ &turkey } {
+	}
+
+	void quack() const {
+		TRACE_SPAN("TurkeyToDuckAdapter::quack");
+		m_turkey->gobble();
+	}
+
+	void fly() const {
+		TRACE_SPAN("TurkeyToDuckAdapter::fly");
+		m_turkey->fly();
+	}
+
+private:
+	Turkey* m_turkey;
+};
+
+
+// ---------- Adapter Selection ----------
+// Maps (target interface, adaptee type) to an adapter.  New adaptee families
+// are supported by adding another specialization.
+template <typename Target, typename Adaptee>
+struct AdapterFor;
+
+template <TurkeyLike Turkey>
+struct AdapterFor<DuckClass, Turkey> {
+	using type = TurkeyToDuckAdapter<Turkey>;
+};
+
+// adapt<DuckClass>(turkey) returns the compile-time adapter for the turkey's
+// concrete type.  Something that already is a duck needs no adapter.
+template <typename Target, typename Adaptee>
+auto adapt(Adaptee& adaptee) {
+	if constexpr (std::derived_from<Adaptee, Target>) {
+		return std::ref(adaptee);
+	} else {
+		return typename AdapterFor<Target, Adaptee>::type{ adaptee };
+	}
+}
+
+
+// ---------- Type-Erased Boundary ----------
+// Falls back to the DuckClass vtable only where one is required
+template <DuckLike Duck>
+class ErasedDuck : public DuckClass {
+public:
+	explicit ErasedDuck(Duck duck)
+		:m_duck{ duck } {
+	}
+	void quack() const override {
+		m_duck.quack();
+	}
+	void fly() const override {
+		m_duck.fly();
+	}
+private:
+	Duck m_duck;
+};
+
+template <DuckLike Duck>
+std::unique_ptr<DuckClass> erase_duck(Duck duck) {
+	return std::make_unique<ErasedDuck<Duck>>(duck);
+}
+
+
+// ---------- Adaptees ----------
+// A turkey from a vendor that never heard of TurkeyClass.  It only has to
+// satisfy TurkeyLike.
+class WildTurkey {
+public:
+	void gobble() {
+		print("Wild turkey gobbling");
+	}
+	void fly() {
+		print("Wild turkey flying a short distance");
+	}
+};
+
+
+// Used by the benchmark: reachable through TurkeyClass (for the virtual
+// adapter) and as a concrete final type (for the compile-time adapter), so
+// all three timings use the same turkey.  Each call bumps a counter through
+// do_not_optimize(), so no loop can be optimized away.
+class CountingTurkey final : public TurkeyClass {
+public:
+	void gobble() override {
+		do_not_optimize(++m_gobbles);
+	}
+	void fly() override {
+		do_not_optimize(++m_flights);
+	}
+	long long get_calls() const {
+		return m_gobbles + m_flights;
+	}
+private:
+	long long m_gobbles = 0;
+	long long m_flights = 0;
+};
+
+
+// ---------- Duck Test ---------
+// The client written against the concept.  std::reference_wrapper is unwrapped
+// so adapt() results of real ducks can be passed too.
+template <typename Duck>
+void test_duck(const Duck& duck) requires DuckLike<Duck> {
+	duck.fly();
+	duck.quack();
+}
+
+template <DuckLike Duck>
+void test_duck(std::reference_wrapper<Duck> duck) {
+	test_duck(duck.get());
+}
+
+
+// ---------------- Benchmark ----------------
+// Runs test_duck() 'count' times on the same kind of turkey (CountingTurkey),
+// three ways.  Returns nanoseconds for {turkey called directly, compile-time
+// adapter, virtual adapter from Adapter.hpp}, and the number of turkey calls
+// each way (equal when every call really ran).
+struct AdapterTimings {
+	long long m_direct_ns;
+	long long m_static_ns;
+	long long m_virtual_ns;
+	long long m_direct_calls;
+	long long m_static_calls;
+	long long m_virtual_calls;
+};
+
+inline AdapterTimings benchmark_adapters(std::size_t count) {
+
+	using Clock = std::chrono::steady_clock;
+	AdapterTimings timings{};
+
+	std::vector<CountingTurkey> direct_turkeys(count);
+	auto start = Clock::now();
+	for (CountingTurkey& turkey : direct_turkeys) {
+		turkey.fly();
+		turkey.gobble();
+	}
+	timings.m_direct_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+
+	std::vector<CountingTurkey> static_turkeys(count);
+	start = Clock::now();
+	for (CountingTurkey& turkey : static_turkeys) {
+		test_duck(adapt<DuckClass>(turkey));
+	}
+	timings.m_static_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+
+	// The original runtime adapter reaches the same turkey through TurkeyClass
+	std::vector<CountingTurkey> virtual_turkeys(count);
+	std::vector<TurkeyToDuckAdapterClass> adapters;
+	adapters.reserve(count);
+	for (CountingTurkey& turkey : virtual_turkeys) {
+		adapters.emplace_back(&turkey);
+	}
+	start = Clock::now();
+	for (TurkeyToDuckAdapterClass& adapter : adapters) {
+		test_duck(static_cast<DuckClass*>(&adapter));
+	}
+	timings.m_virtual_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+
+	for (std::size_t i = 0; i < count; ++i) {
+		timings.m_direct_calls += direct_turkeys[i].get_calls();
+		timings.m_static_calls += static_turkeys[i].get_calls();
+		timings.m_virtual_calls += virtual_turkeys[i].get_calls();
+	}
+	return timings;
+}
+
+
+// ---------------- Example ----------------
+inline void adapter_2() {
+
+	WildTurkey wild_turkey;
+	FluffyDuckClass fluffy_duck;
+
+	// Static dispatch all the way down
+	test_duck(adapt<DuckClass>(wild_turkey));
+	test_duck(adapt<DuckClass>(fluffy_duck));
+
+	// Type-erased boundary: a container of mixed ducks
+	std::vector<std::unique_ptr<DuckClass>> flock;
+	flock.push_back(erase_duck(adapt<DuckClass>(wild_turkey)));
+	flock.push_back(std::make_unique<FluffyDuckClass>());
+	for (const auto& duck : flock) {
+		test_duck(duck.get());
+	}
+
+	const std::size_t count = 5000000;
+	const AdapterTimings timings = benchmark_adapters(count);
+	print("test_duck() x " + std::to_string(count) + " on a CountingTurkey");
+	print("  turkey called directly: " + std::to_string(timings.m_direct_ns / 1000) + " us, " + std::to_string(timings.m_direct_calls) + " turkey calls");
+	print("  compile-time adapter:   " + std::to_string(timings.m_static_ns / 1000) + " us, " + std::to_string(timings.m_static_calls) + " turkey calls");
+	print("  virtual adapter:        " + std::to_string(timings.m_virtual_ns / 1000) + " us, " + std::to_string(timings.m_virtual_calls) + " turkey calls");
+}
@@ -0,0 +1,226 @@
+#pragma once
+#include "Print.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Concept From: Head First Design Patterns
+// Example in C++ written by: Paul Burgess
+
+// Batch Adapters
+// Adapter.hpp translates one call at a time.  When the thing being adapted is
+// data (e.g. a new vendor sends records in its own layout and units), it is
+// far cheaper to translate whole batches: one call converts thousands of
+// records, and the conversion loop is simple enough for the compiler to
+// vectorize (with SSE in the default x86-64 build).
+
+// The structure is the same as TurkeyToDuckAdapterClass: the adapter
+// implements the interface the client wants (a source of DuckRecords) and
+// holds the adaptee (a source of vendor records).  Because sources are read in
+// batches, the adapter also streams: files larger than memory are converted
+// one batch at a time.
+
+
+// ---------- Record Layouts ----------
+// What our code expects (metric units)
+struct DuckRecord {
+	std::uint32_t m_id;
+	float m_weight_kg;
+	float m_wingspan_cm;
+	std::uint32_t m_age_days;
+};
+
+// What the vendor sends: different field order, imperial units, ages in weeks
+struct TurkeyFarmRecord {
+	float m_wingspan_in;
+	float m_weight_lb;
+	std::uint32_t m_tag_number;
+	std::uint32_t m_age_weeks;
+};
+
+
+// ---------- Record Source Interface ----------
+// Fills as much of 'out' as it can and returns the number of records written.
+// Returns 0 once the source is exhausted.
+template <typename Record>
+class IRecordSource {
+public:
+	virtual ~IRecordSource() = default;
+	virtual std::size_t read(std::span<Record> out) = 0;
+};
+
+// Records already in memory
+template <typename Record>
+class SpanRecordSource : public IRecordSource<Record> {
+public:
+	explicit SpanRecordSource(std::span<const Record> records)
+		:m_records{ records } {
+	}
+	std::size_t read(std::span<Record> out) override {
+		const std::size_t count = std::min(out.size(), m_records.size());
+		std::copy_n(m_records.begin(), count, out.begin());
+		m_records = m_records.subspan(count);
+		return count;
+	}
+private:
+	std::span<const Record> m_records;
+};
+
+// Raw records from a stream (e.g. a std::ifstream opened in binary mode).  A
+// record split across two reads is carried over to the next read.  Throws
+// std::runtime_error if the stream ends in the middle of a record.
+template <typename Record>
+class StreamRecordSource : public IRecordSource<Record> {
+public:
+	explicit StreamRecordSource(std::istream& in)
+		:m_in{ in } {
+	}
+	std::size_t read(std::span<Record> out) override {
+		if (out.empty()) {
+			return 0;
+		}
+		char* bytes = reinterpret_cast<char*>(out.data());
+		std::copy_n(m_partial, m_partial_size, bytes);
+		m_in.read(bytes + m_partial_size, static_cast<std::streamsize>(out.size_bytes() - m_partial_size));
+		const std::size_t total_bytes = m_partial_size + static_cast<std::size_t>(m_in.gcount());
+
+		const std::size_t count = total_bytes / sizeof(Record);
+		m_partial_size = total_bytes % sizeof(Record);
+		std::copy_n(bytes + count * sizeof(Record), m_partial_size, m_partial);
+		if (count == 0 && m_partial_size != 0) {
+			throw std::runtime_error("StreamRecordSource: input ends with a partial record (" + std::to_string(m_partial_size)
+				+ " of " + std::to_string(sizeof(Record)) + " bytes)");
+		}
+		return count;
+	}
+private:
+	std::istream& m_in;
+	char m_partial[sizeof(Record)] = {};
+	std::size_t m_partial_size = 0;
+};
+
+
+// ---------- Conversion Kernel ----------
+// Straight-line field moves and multiplies with no branches.  At -O3 GCC
+// vectorizes this loop with 16-byte (SSE) vectors; the field shuffle becomes
+// a few permutes per group of records.  Building with -mavx2 (or /arch:AVX2)
+// lets it use 32-byte vectors.
+inline void convert_turkey_farm_records(std::span<const TurkeyFarmRecord> in, std::span<DuckRecord> out) {
+	constexpr float kg_per_lb = 0.45359237f;
+	constexpr float cm_per_in = 2.54f;
+
+	const std::size_t count = std::min(in.size(), out.size());
+	const TurkeyFarmRecord* source = in.data();
+	DuckRecord* destination = out.data();
+	for (std::size_t i = 0; i < count; ++i) {
+		destination[i].m_id = source[i].m_tag_number;
+		destination[i].m_weight_kg = source[i].m_weight_lb * kg_per_lb;
+		destination[i].m_wingspan_cm = source[i].m_wingspan_in * cm_per_in;
+		destination[i].m_age_days = source[i].m_age_weeks * 7;
+	}
+}
+
+
+// ---------- Adapter ----------
+// Looks like a source of DuckRecords.  Reads the vendor's records into a
+// scratch batch and converts them in one pass.
+class TurkeyFarmToDuckRecordAdapter : public IRecordSource<DuckRecord> {
+public:
+	TurkeyFarmToDuckRecordAdapter(IRecordSource<TurkeyFarmRecord>* turkey_farm_source, std::size_t batch_size = 4096)
+		:m_turkey_farm_source{ turkey_farm_source },
+		m_scratch(batch_size) {
+	}
+
+	std::size_t read(std::span<DuckRecord> out) override {
+		TRACE_SPAN("TurkeyFarmToDuckRecordAdapter::read");
+		std::size_t total = 0;
+		while (total < out.size()) {
+			const std::size_t wanted = std::min(out.size() - total, m_scratch.size());
+			const std::size_t count = m_turkey_farm_source->read(std::span<TurkeyFarmRecord>{ m_scratch.data(), wanted });
+			if (count == 0) {
+				break;
+			}
+			convert_turkey_farm_records(std::span<const TurkeyFarmRecord>{ m_scratch.data(), count }, out.subspan(total, count));
+			total += count;
+		}
+		return total;
+	}
+
+private:
+	IRecordSource<TurkeyFarmRecord>* m_turkey_farm_source;
+	std::vector<TurkeyFarmRecord> m_scratch;
+};
+
+
+// ---------- Streaming ----------
+// Pulls from any record source and writes raw records to 'out' one batch at a
+// time, so memory use does not depend on the size of the input
+template <typename Record>
+std::size_t stream_records(IRecordSource<Record>& source, std::ostream& out, std::size_t batch_size = 4096) {
+	std::vector<Record> batch(batch_size);
+	std::size_t total = 0;
+	for (;;) {
+		const std::size_t count = source.read(batch);
+		if (count == 0) {
+			break;
+		}
+		out.write(reinterpret_cast<const char*>(batch.data()), static_cast<std::streamsize>(count * sizeof(Record)));
+		total += count;
+	}
+	return total;
+}
+
+
+// ---------------- Example ----------------
+inline void adapter_3() {
+
+	// The vendor's data
+	const std::size_t record_count = 1000000;
+	std::vector<TurkeyFarmRecord> turkey_farm_records(record_count);
+	for (std::size_t i = 0; i < record_count; ++i) {
+		turkey_farm_records[i] = TurkeyFarmRecord{ 30.0f + i % 10, 10.0f + i % 20, static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(i % 52) };
+	}
+
+	// In memory: one call converts the whole batch
+	std::vector<DuckRecord> duck_records(record_count);
+	auto start = std::chrono::steady_clock::now();
+	convert_turkey_farm_records(turkey_farm_records, duck_records);
+	const auto convert_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+	print("Converted " + std::to_string(record_count) + " records in " + std::to_string(convert_time.count()) + " us");
+	print("Record 7: id " + std::to_string(duck_records[7].m_id) + ", " + std::to_string(duck_records[7].m_weight_kg) + " kg, "
+		+ std::to_string(duck_records[7].m_wingspan_cm) + " cm, " + std::to_string(duck_records[7].m_age_days) + " days");
+
+	// Streaming: the vendor "file" is read and converted batch by batch.  A
+	// std::ifstream/std::ofstream pair works the same way for real files.
+	std::stringstream vendor_file;
+	vendor_file.write(reinterpret_cast<const char*>(turkey_farm_records.data()), static_cast<std::streamsize>(record_count * sizeof(TurkeyFarmRecord)));
+	std::stringstream converted_file;
+
+	StreamRecordSource<TurkeyFarmRecord> vendor_source{ vendor_file };
+	TurkeyFarmToDuckRecordAdapter adapter{ &vendor_source };
+	start = std::chrono::steady_clock::now();
+	const std::size_t streamed = stream_records<DuckRecord>(adapter, converted_file);
+	const auto stream_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+	print("Streamed " + std::to_string(streamed) + " records in " + std::to_string(stream_time.count()) + " us");
+
+	// A file cut off in the middle of a record is reported, not silently
+	// shortened
+	std::stringstream truncated_file{ vendor_file.str().substr(0, 10 * sizeof(TurkeyFarmRecord) + 6) };
+	StreamRecordSource<TurkeyFarmRecord> truncated_source{ truncated_file };
+	TurkeyFarmToDuckRecordAdapter truncated_adapter{ &truncated_source };
+	std::stringstream discarded;
+	try {
+		stream_records<DuckRecord>(truncated_adapter, discarded);
+	} catch (const std::runtime_error& error) {
+		print(error.what());
+	}
+}
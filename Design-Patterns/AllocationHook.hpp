@@ -0,0 +1,155 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+// Example in C++ written by: Paul Burgess
+
+// Allocation Hook
+// Counts heap allocations made by the current thread, so code can check that
+// a section (a real-time loop, a notify path) does not allocate:
+//
+//     const AllocationCounts before = get_thread_allocation_counts();
+//     ... code under test ...
+//     const AllocationCounts during = get_thread_allocation_counts() - before;
+//
+// The counting works by replacing the global operator new/delete.  A program
+// may only do that once, so the replacement functions are compiled only in
+// the one source file that defines DESIGN_PATTERNS_ALLOCATION_HOOK before
+// including this header (Tests/RealTimeAllocationCheck.cpp does).  Everywhere
+// else the counters stay at zero and allocation_hook_installed() returns
+// false.
+
+
+// ---------- Counters ----------
+struct AllocationCounts {
+	std::uint64_t m_allocations = 0;
+	std::uint64_t m_deallocations = 0;
+	std::uint64_t m_bytes = 0;
+
+	AllocationCounts operator-(const AllocationCounts& rhs) const {
+		return AllocationCounts{ m_allocations - rhs.m_allocations, m_deallocations - rhs.m_deallocations, m_bytes - rhs.m_bytes };
+	}
+};
+
+// Trivial type, so the thread_local needs no constructor (and so never
+// allocates from inside operator new)
+inline AllocationCounts& thread_allocation_counts() {
+	thread_local AllocationCounts counts;
+	return counts;
+}
+
+inline AllocationCounts get_thread_allocation_counts() {
+	return thread_allocation_counts();
+}
+
+inline bool& allocation_hook_flag() {
+	static bool installed = false;
+	return installed;
+}
+
+inline bool allocation_hook_installed() {
+	return allocation_hook_flag();
+}
+
+// For printing a measured count: "n/a" when the hook is not installed, since
+// the counters then read 0 whatever the code did
+inline std::string format_allocation_count(std::uint64_t count) {
+	return allocation_hook_installed() ? std::to_string(count) : std::string{ "n/a" };
+}
+
+
+// ---------- Replacement operator new/delete (one source file only) ----------
+#if defined(DESIGN_PATTERNS_ALLOCATION_HOOK)
+
+namespace allocation_hook_detail {
+
+	inline void* allocate(std::size_t size) {
+		AllocationCounts& counts = thread_allocation_counts();
+		++counts.m_allocations;
+		counts.m_bytes += size;
+		if (void* memory = std::malloc(size == 0 ? 1 : size)) {
+			return memory;
+		}
+		throw std::bad_alloc{};
+	}
+
+	inline void* allocate_aligned(std::size_t size, std::align_val_t alignment) {
+		AllocationCounts& counts = thread_allocation_counts();
+		++counts.m_allocations;
+		counts.m_bytes += size;
+		const std::size_t align = static_cast<std::size_t>(alignment);
+#if defined(_MSC_VER)
+		void* memory = ::_aligned_malloc(size == 0 ? 1 : size, align);
+#else
+		void* memory = std::aligned_alloc(align, (size + align - 1) / align * align);
+#endif
+		if (memory) {
+			return memory;
+		}
+		throw std::bad_alloc{};
+	}
+
+	inline void release(void* memory) noexcept {
+		if (memory) {
+			++thread_allocation_counts().m_deallocations;
+			std::free(memory);
+		}
+	}
+
+	inline void release_aligned(void* memory) noexcept {
+		if (memory) {
+			++thread_allocation_counts().m_deallocations;
+#if defined(_MSC_VER)
+			::_aligned_free(memory);
+#else
+			std::free(memory);
+#endif
+		}
+	}
+
+	static const bool installed = (allocation_hook_flag() = true);
+}
+
+// Replacement functions may not be inline; this is why only one source file
+// may compile them
+void* operator new(std::size_t size) {
+	return allocation_hook_detail::allocate(size);
+}
+void* operator new[](std::size_t size) {
+	return allocation_hook_detail::allocate(size);
+}
+void* operator new(std::size_t size, std::align_val_t alignment) {
+	return allocation_hook_detail::allocate_aligned(size, alignment);
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+	return allocation_hook_detail::allocate_aligned(size, alignment);
+}
+void operator delete(void* memory) noexcept {
+	allocation_hook_detail::release(memory);
+}
+void operator delete[](void* memory) noexcept {
+	allocation_hook_detail::release(memory);
+}
+void operator delete(void* memory, std::size_t) noexcept {
+	allocation_hook_detail::release(memory);
+}
+void operator delete[](void* memory, std::size_t) noexcept {
+	allocation_hook_detail::release(memory);
+}
+void operator delete(void* memory, std::align_val_t) noexcept {
+	allocation_hook_detail::release_aligned(memory);
+}
+void operator delete[](void* memory, std::align_val_t) noexcept {
+	allocation_hook_detail::release_aligned(memory);
+}
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept {
+	allocation_hook_detail::release_aligned(memory);
+}
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept {
+	allocation_hook_detail::release_aligned(memory);
+}
+
+#endif
@@ -0,0 +1,258 @@
+#pragma once
+#include "Print.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Example in C++ written by: Paul Burgess
+
+// Benchmark Harness
+// A small, self-contained micro-benchmark runner (no third-party library).
+// Each benchmark is registered with a setup function.  The setup runs once,
+// outside the timed region, and returns the loop body to time.  The body is
+// given an iteration count and must run the hot path that many times.
+
+// For every benchmark the harness:
+//   1. Calibrates: grows the iteration count until one run takes at least
+//      the minimum time
+//   2. Repeats the run several times with that count
+//   3. Reports the median (plus min and max) time per iteration
+// Printing is switched off while benchmarks run so the console is not timed.
+
+// Results can be written as a table (for people) or as JSON (for regression
+// tracking: diff the JSON of two builds).
+
+
+// ---------- Optimizer Barriers ----------
+// Keeps the compiler from deleting work whose result is never used
+template <typename T>
+inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	const volatile char* volatile sink = reinterpret_cast<const volatile char*>(&value);
+	(void)sink;
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+// Forces pending writes to memory to be treated as observable
+inline void clobber_memory() {
+	std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+
+
+// ---------- Results ----------
+struct BenchmarkResult {
+	std::string m_name;
+	std::size_t m_iterations;           // per repetition
+	std::size_t m_repetitions;
+	std::size_t m_items_per_iteration;  // e.g. observers notified per call
+	double m_ns_per_iteration;          // median of the repetitions
+	double m_min_ns_per_iteration;
+	double m_max_ns_per_iteration;
+
+	double ns_per_item() const {
+		return m_ns_per_iteration / static_cast<double>(m_items_per_iteration);
+	}
+};
+
+
+// ---------- Suite ----------
+class BenchmarkSuite {
+
+public:
+	using Body = std::function<void(std::size_t iterations)>;
+	using Setup = std::function<Body()>;
+
+	void add(const std::string& name, Setup setup, std::size_t items_per_iteration = 1) {
+		m_benchmarks.push_back(Entry{ name, std::move(setup), items_per_iteration == 0 ? 1 : items_per_iteration });
+	}
+
+	void set_min_time(std::chrono::milliseconds min_time) {
+		m_min_time = min_time < std::chrono::milliseconds::zero() ? std::chrono::milliseconds::zero() : min_time;
+	}
+
+	void set_repetitions(std::size_t repetitions) {
+		m_repetitions = repetitions == 0 ? 1 : repetitions;
+	}
+
+	std::vector<std::string> get_names() const {
+		std::vector<std::string> names;
+		for (const Entry& entry : m_benchmarks) {
+			names.push_back(entry.m_name);
+		}
+		return names;
+	}
+
+	// Runs every benchmark whose name contains 'filter' (all when empty)
+	std::vector<BenchmarkResult> run(const std::string& filter = "") const {
+		const bool was_printing = print_enabled();
+		print_enabled() = false;
+
+		std::vector<BenchmarkResult> results;
+		for (const Entry& entry : m_benchmarks) {
+			if (!filter.empty() && entry.m_name.find(filter) == std::string::npos) {
+				continue;
+			}
+			results.push_back(run_one(entry));
+		}
+
+		print_enabled() = was_printing;
+		return results;
+	}
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	struct Entry {
+		std::string m_name;
+		Setup m_setup;
+		std::size_t m_items_per_iteration;
+	};
+
+	static double time_ns(const Body& body, std::size_t iterations) {
+		const Clock::time_point start = Clock::now();
+		body(iterations);
+		clobber_memory();
+		return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+	}
+
+	BenchmarkResult run_one(const Entry& entry) const {
+		const Body body = entry.m_setup();
+		const double min_ns = std::chrono::duration<double, std::nano>(m_min_time).count();
+
+		// Calibration: aim a little past the minimum time so the repetitions
+		// do not fall just short of it
+		std::size_t iterations = 1;
+		double elapsed = time_ns(body, iterations);
+		while (elapsed < min_ns && iterations < max_iterations) {
+			const double scale = elapsed > 0.0 ? 1.4 * min_ns / elapsed : 10.0;
+			const double next = static_cast<double>(iterations) * std::clamp(scale, 2.0, 10.0);
+			iterations = next >= static_cast<double>(max_iterations) ? max_iterations : static_cast<std::size_t>(next);
+			elapsed = time_ns(body, iterations);
+		}
+
+		std::vector<double> per_iteration;
+		for (std::size_t i = 0; i < m_repetitions; ++i) {
+			per_iteration.push_back(time_ns(body, iterations) / static_cast<double>(iterations));
+		}
+		std::sort(per_iteration.begin(), per_iteration.end());
+
+		return BenchmarkResult{
+			entry.m_name,
+			iterations,
+			m_repetitions,
+			entry.m_items_per_iteration,
+			per_iteration[per_iteration.size() / 2],
+			per_iteration.front(),
+			per_iteration.back()
+		};
+	}
+
+	static constexpr std::size_t max_iterations = 1000000000;
+
+	std::vector<Entry> m_benchmarks;
+	std::chrono::milliseconds m_min_time{ 100 };
+	std::size_t m_repetitions = 5;
+};
+
+
+// ---------- Reporters ----------
+inline void write_benchmark_table(std::ostream& out, const std::vector<BenchmarkResult>& results) {
+	std::size_t name_width = 9;
+	for (const BenchmarkResult& result : results) {
+		name_width = std::max(name_width, result.m_name.size());
+	}
+
+	out << std::left << std::setw(static_cast<int>(name_width)) << "Benchmark"
+		<< std::right << std::setw(14) << "ns/iter"
+		<< std::setw(14) << "ns/item"
+		<< std::setw(14) << "iterations" << "\n";
+	out << std::fixed << std::setprecision(2);
+	for (const BenchmarkResult& result : results) {
+		out << std::left << std::setw(static_cast<int>(name_width)) << result.m_name
+			<< std::right << std::setw(14) << result.m_ns_per_iteration
+			<< std::setw(14) << result.ns_per_item()
+			<< std::setw(14) << result.m_iterations << "\n";
+	}
+	out << std::defaultfloat;
+}
+
+// Control characters (below 0x20) are not allowed raw in a JSON string
+inline std::string escape_json(const std::string& text) {
+	const char* const hex_digits = "0123456789abcdef";
+	std::string escaped;
+	for (const char c : text) {
+		switch (c) {
+		case '"': escaped += "\\\""; break;
+		case '\\': escaped += "\\\\"; break;
+		case '\n': escaped += "\\n"; break;
+		case '\t': escaped += "\\t"; break;
+		default:
+			if (static_cast<unsigned char>(c) < 0x20) {
+				escaped += "\\u00";
+				escaped += hex_digits[static_cast<unsigned char>(c) >> 4];
+				escaped += hex_digits[static_cast<unsigned char>(c) & 0xf];
+			} else {
+				escaped += c;
+			}
+			break;
+		}
+	}
+	return escaped;
+}
+
+// One object with the build context and a "benchmarks" array.  Times are in
+// nanoseconds.
+inline void write_benchmark_json(std::ostream& out, const std::vector<BenchmarkResult>& results) {
+
+#if defined(__clang__)
+	const std::string compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+	const std::string compiler = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+	const std::string compiler = "msvc " + std::to_string(_MSC_VER);
+#else
+	const std::string compiler = "unknown";
+#endif
+
+#if defined(NDEBUG)
+	const std::string build_type = "release";
+#else
+	const std::string build_type = "debug";
+#endif
+
+	std::ostringstream json;
+	json << std::setprecision(6);
+	json << "{\n";
+	json << "  \"context\": {\n";
+	json << "    \"compiler\": \"" << escape_json(compiler) << "\",\n";
+	json << "    \"build_type\": \"" << build_type << "\",\n";
+	json << "    \"cpp_standard\": " << __cplusplus << ",\n";
+	json << "    \"hardware_threads\": " << std::thread::hardware_concurrency() << "\n";
+	json << "  },\n";
+	json << "  \"benchmarks\": [";
+	for (std::size_t i = 0; i < results.size(); ++i) {
+		const BenchmarkResult& result = results[i];
+		json << (i == 0 ? "\n" : ",\n");
+		json << "    {\"name\": \"" << escape_json(result.m_name) << "\""
+			<< ", \"iterations\": " << result.m_iterations
+			<< ", \"repetitions\": " << result.m_repetitions
+			<< ", \"items_per_iteration\": " << result.m_items_per_iteration
+			<< ", \"ns_per_iteration\": " << result.m_ns_per_iteration
+			<< ", \"min_ns_per_iteration\": " << result.m_min_ns_per_iteration
+			<< ", \"max_ns_per_iteration\": " << result.m_max_ns_per_iteration
+			<< ", \"ns_per_item\": " << result.ns_per_item() << "}";
+	}
+	json << "\n  ]\n}\n";
+	out << json.str();
+}
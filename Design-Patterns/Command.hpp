@@ -1,5 +1,6 @@
 #pragma once
 #include "Print.hpp"
+#include "Trace.hpp"
 
 // Concept From: Head First Design Patterns
 // Example in C++ written by: Paul Burgess
@@ -10,7 +11,7 @@
 // E.g. Remote::press_button() -> CommandObject::execute() -> Receiver::turn_on()
 
 // Definitions
-// Client: Responsible for creating a Command and setting its receiver.  In the example below, the 'main()' function is the receiver.
+// Client: Responsible for creating a Command and setting its receiver.  In the example below, the 'command_1()' function is the client.
 // Invoker: Holds a command and asks that command to carry out a request by calling its execute() function.
 // Receiver: Knows how to perform the work needed to carry out the request.
 // Command Interface: Declared for all commands.  This function asks the receiver to perform an action (e.g. turn_on()).
@@ -26,6 +27,9 @@ public:
 	void turn_on() const {
 		print("Turning light on");
 	}
+	void turn_off() const {
+		print("Turning light off");
+	}
 };
 
 class GarageDoor {
@@ -46,6 +50,9 @@ public:
 	virtual ~Command() = default;
 	virtual void execute() const = 0;
 
+	// Reverses whatever execute() did (e.g. turn_on() -> turn_off())
+	virtual void undo() const = 0;
+
 };
 
 
@@ -59,6 +66,9 @@ public:
 	void execute() const override {
 		m_light.turn_on();
 	}
+	void undo() const override {
+		m_light.turn_off();
+	}
 private:
 	Light m_light;
 };
@@ -71,6 +81,9 @@ public:
 	void execute() const override {
 		m_garage_door.open();
 	}
+	void undo() const override {
+		m_garage_door.close();
+	}
 private:
 	GarageDoor m_garage_door;
 };
@@ -87,14 +100,19 @@ public:
 		m_command_slot = command;
 	}
 	void press_button() const {
+		TRACE_SPAN("RemoteControl::press_button");
 		m_command_slot->execute();
 	}
+	void press_undo_button() const {
+		TRACE_SPAN("RemoteControl::press_undo_button");
+		m_command_slot->undo();
+	}
 private:
 	Command* m_command_slot;
 };
 
 // ------------- Client -------------
-int main() {
+inline void command_1() {
 
 	// Invoker
 	// The remote control will eventually contain an object that it will call
@@ -121,6 +139,9 @@ int main() {
 	remote_control.set_command(another_command);
 	remote_control.press_button();
 
+	// Changed our mind (the command knows how to reverse itself)
+	remote_control.press_undo_button();
+
 	delete command;
 	delete another_command;
 }
\ No newline at end of file
@@ -0,0 +1,373 @@
+#pragma once
+#include "Print.hpp"
+#include "Trace.hpp"
+#include "Command.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Concept From: Head First Design Patterns
+// Example in C++ written by: Paul Burgess
+
+// Command Queue
+// The RemoteControl in Command.hpp has one slot and runs its command inline
+// on the caller's thread.  A command queue decouples the two sides: any number
+// of producers (clients) enqueue commands, and a pool of executors (the
+// invokers) drain and run them in batches.
+
+// Commands can be given an ordering key (e.g. the address of their receiver).
+// Commands with the same key always run in the order they were submitted.
+// Commands without a key can run on any executor, in any order.
+
+// Like RemoteControl, the queue does not own its commands.  Each command must
+// stay alive until it has executed (see wait_until_idle()).
+
+// Idle executors (and producers waiting on a full queue, and
+// wait_until_idle()) spin briefly, then sleep until there is something to do,
+// so an idle invoker costs no CPU.
+
+
+// ---------- Lock-Free Queue ----------
+// Bounded multi-producer/multi-consumer queue (Dmitry Vyukov's design).  Each
+// cell carries a sequence number that tells producers and consumers whether
+// the cell is ready for them, so no locks are needed.
+template <typename T>
+class MpmcQueue {
+
+public:
+	// Capacity is rounded up to a power of two
+	explicit MpmcQueue(std::size_t capacity)
+		:m_mask{ round_up_to_power_of_two(capacity) - 1 },
+		m_cells{ new Cell[m_mask + 1] },
+		m_enqueue_pos{ 0 },
+		m_dequeue_pos{ 0 } {
+
+		for (std::size_t i = 0; i <= m_mask; ++i) {
+			m_cells[i].m_sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	MpmcQueue(const MpmcQueue&) = delete;
+	MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+	// Returns false when the queue is full
+	bool try_push(const T& value) {
+		std::size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+		for (;;) {
+			Cell& cell = m_cells[pos & m_mask];
+			const std::size_t sequence = cell.m_sequence.load(std::memory_order_acquire);
+			const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+			if (diff == 0) {
+				if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					cell.m_value = value;
+					cell.m_sequence.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			} else if (diff < 0) {
+				return false;
+			} else {
+				pos = m_enqueue_pos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// Returns false when the queue is empty
+	bool try_pop(T& value) {
+		std::size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+		for (;;) {
+			Cell& cell = m_cells[pos & m_mask];
+			const std::size_t sequence = cell.m_sequence.load(std::memory_order_acquire);
+			const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+			if (diff == 0) {
+				if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					value = cell.m_value;
+					cell.m_sequence.store(pos + m_mask + 1, std::memory_order_release);
+					return true;
+				}
+			} else if (diff < 0) {
+				return false;
+			} else {
+				pos = m_dequeue_pos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+private:
+	struct Cell {
+		std::atomic<std::size_t> m_sequence;
+		T m_value;
+	};
+
+	static std::size_t round_up_to_power_of_two(std::size_t value) {
+		std::size_t result = 2;
+		while (result < value) {
+			result <<= 1;
+		}
+		return result;
+	}
+
+	const std::size_t m_mask;
+	const std::unique_ptr<Cell[]> m_cells;
+
+	// Producers and consumers each get their own cache line
+	alignas(64) std::atomic<std::size_t> m_enqueue_pos;
+	alignas(64) std::atomic<std::size_t> m_dequeue_pos;
+};
+
+
+// ---------- Wake Signal ----------
+// Lets threads sleep until a condition (made of atomics) becomes true.  The
+// thread that makes it true calls notify(), which only takes the lock when
+// someone is asleep, so the hot path stays lock-free.
+class WakeSignal {
+
+public:
+	// Spins for a while, then sleeps.  ready() is called with the lock held
+	// once the thread is about to sleep.
+	template <typename Predicate>
+	void wait_until(Predicate ready) {
+		for (std::size_t spin = 0; spin < spin_count; ++spin) {
+			if (ready()) {
+				return;
+			}
+			std::this_thread::yield();
+		}
+		std::unique_lock<std::mutex> lock{ m_mutex };
+		// seq_cst on both sides: either the waker sees the sleeper, or the
+		// sleeper's ready() sees the waker's change
+		m_sleepers.fetch_add(1, std::memory_order_seq_cst);
+		m_changed.wait(lock, ready);
+		m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	// Call after a seq_cst change that may make a waiter ready
+	void notify() {
+		if (m_sleepers.load(std::memory_order_seq_cst) != 0) {
+			{
+				std::lock_guard<std::mutex> lock{ m_mutex };
+			}
+			m_changed.notify_all();
+		}
+	}
+
+private:
+	static constexpr std::size_t spin_count = 1024;
+
+	std::mutex m_mutex;
+	std::condition_variable m_changed;
+	std::atomic<std::size_t> m_sleepers{ 0 };
+};
+
+
+// ------------ Invoker ------------
+// Keyed commands are routed to the executor that owns their key, which keeps
+// them in order.  Unkeyed commands go to a shared queue that every executor
+// drains once its own queue is empty.
+class CommandQueueInvoker {
+
+public:
+	CommandQueueInvoker(std::size_t executor_count, std::size_t batch_size = 64, std::size_t queue_capacity = 65536)
+		:m_batch_size{ batch_size },
+		m_shared_queue{ queue_capacity },
+		m_submitted{ 0 },
+		m_completed{ 0 },
+		m_running{ true } {
+
+		if (executor_count == 0) {
+			executor_count = 1;
+		}
+		for (std::size_t i = 0; i < executor_count; ++i) {
+			m_keyed_queues.push_back(std::make_unique<MpmcQueue<const Command*>>(queue_capacity));
+		}
+		for (std::size_t i = 0; i < executor_count; ++i) {
+			m_executors.emplace_back(&CommandQueueInvoker::run_executor, this, i);
+		}
+	}
+
+	CommandQueueInvoker(const CommandQueueInvoker&) = delete;
+	CommandQueueInvoker& operator=(const CommandQueueInvoker&) = delete;
+
+	// Runs everything already submitted, then stops the executors
+	~CommandQueueInvoker() {
+		wait_until_idle();
+		m_running.store(false, std::memory_order_seq_cst);
+		m_work_signal.notify();
+		for (auto& executor : m_executors) {
+			executor.join();
+		}
+	}
+
+	// Unordered: may run on any executor
+	void submit(const Command* command) {
+		m_submitted.fetch_add(1, std::memory_order_relaxed);
+		push(m_shared_queue, command);
+	}
+
+	// Ordered: runs after every earlier command submitted with the same key
+	void submit(const Command* command, std::size_t ordering_key) {
+		MpmcQueue<const Command*>& queue = *m_keyed_queues[spread_key(ordering_key) % m_keyed_queues.size()];
+		m_submitted.fetch_add(1, std::memory_order_relaxed);
+		push(queue, command);
+	}
+
+	// Convenience key: commands acting on the same receiver stay in order
+	void submit(const Command* command, const void* receiver) {
+		submit(command, reinterpret_cast<std::size_t>(receiver));
+	}
+
+	// Blocks until every submitted command has executed
+	void wait_until_idle() const {
+		m_progress_signal.wait_until([this]() {
+			return m_completed.load(std::memory_order_seq_cst) == m_submitted.load(std::memory_order_seq_cst);
+		});
+	}
+
+	std::size_t executor_count() const {
+		return m_executors.size();
+	}
+
+private:
+	// Keys are often pointers, whose low bits are always zero.  Mix the bits
+	// (Fibonacci hashing) so keys spread evenly over the executors.
+	static std::size_t spread_key(std::size_t key) {
+		return static_cast<std::size_t>((static_cast<unsigned long long>(key) * 0x9E3779B97F4A7C15ull) >> 32);
+	}
+
+	// A full queue waits for executors to make progress
+	void push(MpmcQueue<const Command*>& queue, const Command* command) {
+		if (!queue.try_push(command)) {
+			m_progress_signal.wait_until([&queue, command]() {
+				return queue.try_push(command);
+			});
+		}
+		m_pushed.fetch_add(1, std::memory_order_seq_cst);
+		m_work_signal.notify();
+	}
+
+	void run_executor(std::size_t index) {
+		MpmcQueue<const Command*>& own_queue = *m_keyed_queues[index];
+		std::vector<const Command*> batch;
+		batch.reserve(m_batch_size);
+
+		while (true) {
+			// Read before polling: any push after this changes it
+			const std::size_t pushed = m_pushed.load(std::memory_order_seq_cst);
+
+			// Own (ordered) work first, then top the batch up with shared work
+			const Command* command = nullptr;
+			while (batch.size() < m_batch_size && own_queue.try_pop(command)) {
+				batch.push_back(command);
+			}
+			while (batch.size() < m_batch_size && m_shared_queue.try_pop(command)) {
+				batch.push_back(command);
+			}
+
+			if (batch.empty()) {
+				if (!m_running.load(std::memory_order_seq_cst)) {
+					return;
+				}
+				m_work_signal.wait_until([this, pushed]() {
+					return m_pushed.load(std::memory_order_seq_cst) != pushed || !m_running.load(std::memory_order_seq_cst);
+				});
+				continue;
+			}
+
+			TRACE_SPAN("CommandQueueInvoker::execute_batch");
+			for (const Command* batched_command : batch) {
+				batched_command->execute();
+			}
+			m_completed.fetch_add(batch.size(), std::memory_order_seq_cst);
+			m_progress_signal.notify();
+			batch.clear();
+		}
+	}
+
+	const std::size_t m_batch_size;
+	std::vector<std::unique_ptr<MpmcQueue<const Command*>>> m_keyed_queues;
+	MpmcQueue<const Command*> m_shared_queue;
+
+	alignas(64) std::atomic<std::size_t> m_submitted;
+	alignas(64) std::atomic<std::size_t> m_completed;
+	alignas(64) std::atomic<std::size_t> m_pushed{ 0 };  // commands actually in a queue
+	std::atomic<bool> m_running;
+
+	// Wakes sleeping executors when work arrives
+	WakeSignal m_work_signal;
+	// Wakes producers (full queue) and wait_until_idle() when commands complete
+	mutable WakeSignal m_progress_signal;
+
+	std::vector<std::thread> m_executors;
+};
+
+
+// ------------ Receivers -------------
+// A receiver that records how often it ran instead of printing (printing from
+// several executors at once would interleave the output)
+class Thermostat {
+public:
+	void raise() const {
+		m_raised.fetch_add(1, std::memory_order_relaxed);
+	}
+	void lower() const {
+		m_raised.fetch_sub(1, std::memory_order_relaxed);
+	}
+	int get_raised_count() const {
+		return m_raised.load(std::memory_order_relaxed);
+	}
+private:
+	mutable std::atomic<int> m_raised{ 0 };
+};
+
+class ThermostatRaiseCommand : public Command {
+public:
+	ThermostatRaiseCommand(const Thermostat* thermostat)
+		:m_thermostat{ thermostat } {
+	}
+	void execute() const override {
+		m_thermostat->raise();
+	}
+	void undo() const override {
+		m_thermostat->lower();
+	}
+private:
+	const Thermostat* m_thermostat;
+};
+
+
+// ------------- Client -------------
+inline void command_2() {
+
+	const Thermostat upstairs;
+	const Thermostat downstairs;
+	const ThermostatRaiseCommand raise_upstairs{ &upstairs };
+	const ThermostatRaiseCommand raise_downstairs{ &downstairs };
+
+	{
+		CommandQueueInvoker invoker{ 4 };
+
+		// Two producers.  Upstairs commands are keyed by their receiver, so
+		// they run in submission order; downstairs commands can run anywhere.
+		std::thread upstairs_producer{ [&]() {
+			for (int i = 0; i < 100000; ++i) {
+				invoker.submit(&raise_upstairs, &upstairs);
+			}
+		} };
+		std::thread downstairs_producer{ [&]() {
+			for (int i = 0; i < 100000; ++i) {
+				invoker.submit(&raise_downstairs);
+			}
+		} };
+		upstairs_producer.join();
+		downstairs_producer.join();
+
+		invoker.wait_until_idle();
+	}
+
+	print("Upstairs raised: " + std::to_string(upstairs.get_raised_count()));
+	print("Downstairs raised: " + std::to_string(downstairs.get_raised_count()));
+}
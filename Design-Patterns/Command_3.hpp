@@ -0,0 +1,482 @@
+#pragma once
+#include "Print.hpp"
+#include "Trace.hpp"
+#include "Command.hpp"
+#include <chrono>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Concept From: Head First Design Patterns
+// Example in C++ written by: Paul Burgess
+
+// Command History (Undo/Redo Journal)
+// Every command that runs is recorded as a small fixed-size entry:
+// (receiver id, opcode, argument).  The entries form an append-only journal.
+// Undo and redo are appended to the journal too, so the journal is a complete
+// record of what happened and can be replayed after a restart.
+
+// Replaying a long journal from the beginning gets slow, so the history takes
+// a snapshot of every receiver every N entries.  A snapshot is just the
+// journal offset and one state per receiver, so its size does not grow with
+// the history.  Recovery loads the latest snapshot and only replays the
+// entries written after it against the receivers.  The undo/redo stacks are
+// rebuilt from the journal itself (bookkeeping only, no receiver calls).
+
+// recover() checks the whole journal before touching any receiver or the
+// history itself: a truncated or corrupt journal, or receivers registered in a
+// different order, throws std::runtime_error instead of replaying garbage.
+
+// The journal is written in the host's byte order.
+
+
+// ------------ Receiver Interface -------------
+// Receivers that take part in the journal are addressed by id (their
+// registration order) and must be able to apply and revert an opcode, and to
+// save and load their state for snapshots.
+class IJournaledReceiver {
+public:
+	virtual ~IJournaledReceiver() = default;
+	virtual void apply(std::uint16_t opcode, std::int64_t argument) = 0;
+	virtual void revert(std::uint16_t opcode, std::int64_t argument) = 0;
+
+	// The example receivers fit their state in one value.  Receivers with more
+	// state would serialize it into a larger blob.
+	virtual std::int64_t save_state() const = 0;
+	virtual void load_state(std::int64_t state) = 0;
+};
+
+
+// ------------ Journal Entry -------------
+enum class JournalAction : std::uint8_t {
+	Execute,
+	Undo,
+	Redo
+};
+
+// 16 bytes per entry.  A million entries is 16 MB and loads in a few large
+// reads with no parsing.
+struct JournalEntry {
+	std::uint32_t m_receiver_id;
+	std::uint16_t m_opcode;
+	JournalAction m_action;
+	std::uint8_t m_reserved;
+	std::int64_t m_argument;
+};
+
+static_assert(sizeof(JournalEntry) == 16, "JournalEntry should stay compact");
+
+
+// -------------- Commands --------------
+// Binds a receiver to one opcode/argument pair
+class JournaledCommand : public Command {
+public:
+	JournaledCommand(IJournaledReceiver* receiver, std::uint32_t receiver_id, std::uint16_t opcode, std::int64_t argument)
+		:m_receiver{ receiver },
+		m_entry{ receiver_id, opcode, JournalAction::Execute, 0, argument } {
+	}
+	void execute() const override {
+		m_receiver->apply(m_entry.m_opcode, m_entry.m_argument);
+	}
+	void undo() const override {
+		m_receiver->revert(m_entry.m_opcode, m_entry.m_argument);
+	}
+	const JournalEntry& get_entry() const {
+		return m_entry;
+	}
+private:
+	IJournaledReceiver* m_receiver;
+	JournalEntry m_entry;
+};
+
+
+// ------------ Invoker ------------
+class CommandHistory {
+
+public:
+	// snapshot_interval: take a snapshot every N journal entries (0 = never)
+	// journal_stream: optional; every entry is also appended here as it is
+	// written, so the journal survives a crash
+	CommandHistory(std::size_t snapshot_interval, std::ostream* journal_stream = nullptr)
+		:m_snapshot_interval{ snapshot_interval },
+		m_journal_stream{ journal_stream } {
+	}
+
+	// Receivers must be registered in the same order before and after a
+	// restart, since their position is their id
+	std::uint32_t add_receiver(IJournaledReceiver* receiver) {
+		m_receivers.push_back(receiver);
+		return static_cast<std::uint32_t>(m_receivers.size() - 1);
+	}
+
+	// Throws std::invalid_argument when the command names an unregistered
+	// receiver id
+	void execute(const JournaledCommand& command) {
+		TRACE_SPAN("CommandHistory::execute");
+		if (command.get_entry().m_receiver_id >= m_receivers.size()) {
+			throw std::invalid_argument("CommandHistory::execute: unknown receiver id " + std::to_string(command.get_entry().m_receiver_id));
+		}
+		command.execute();
+		append(command.get_entry());
+	}
+
+	// Returns false when there is nothing to undo
+	bool undo() {
+		TRACE_SPAN("CommandHistory::undo");
+		if (m_undo_stack.empty()) {
+			return false;
+		}
+		JournalEntry entry = m_undo_stack.back();
+		m_receivers[entry.m_receiver_id]->revert(entry.m_opcode, entry.m_argument);
+		entry.m_action = JournalAction::Undo;
+		append(entry);
+		return true;
+	}
+
+	// Returns false when there is nothing to redo
+	bool redo() {
+		if (m_redo_stack.empty()) {
+			return false;
+		}
+		JournalEntry entry = m_redo_stack.back();
+		m_receivers[entry.m_receiver_id]->apply(entry.m_opcode, entry.m_argument);
+		entry.m_action = JournalAction::Redo;
+		append(entry);
+		return true;
+	}
+
+	const std::vector<JournalEntry>& get_journal() const {
+		return m_journal;
+	}
+
+	// Writes the whole journal (for histories created without a stream)
+	void save_journal(std::ostream& out) const {
+		out.write(reinterpret_cast<const char*>(m_journal.data()), static_cast<std::streamsize>(m_journal.size() * sizeof(JournalEntry)));
+	}
+
+	// Writes a snapshot of the current state: the journal offset plus one
+	// state per receiver
+	void save_snapshot(std::ostream& out) const {
+		const Snapshot snapshot = capture_snapshot();
+		write_value(out, static_cast<std::uint64_t>(snapshot.m_journal_size));
+		write_vector(out, snapshot.m_receiver_states);
+	}
+
+	// Restores the receivers after a restart: load the snapshot (if any), then
+	// replay the journal entries written after it.  Throws std::runtime_error
+	// (leaving the receivers and the history untouched) when the snapshot or
+	// journal is truncated or does not match the registered receivers.
+	void recover(std::istream& journal_in, std::istream* snapshot_in = nullptr) {
+		TRACE_SPAN("CommandHistory::recover");
+		Snapshot snapshot;
+		if (snapshot_in != nullptr) {
+			snapshot = read_snapshot(*snapshot_in);
+		}
+		std::vector<JournalEntry> journal = read_journal(journal_in);
+		if (snapshot.m_journal_size > journal.size()) {
+			fail("snapshot is ahead of the journal (" + std::to_string(snapshot.m_journal_size) + " of " + std::to_string(journal.size()) + " entries)");
+		}
+
+		// Check every entry and rebuild the undo/redo stacks before anything
+		// changes, so a bad journal fails cleanly
+		std::vector<JournalEntry> undo_stack;
+		std::vector<JournalEntry> redo_stack;
+		for (std::size_t i = 0; i < journal.size(); ++i) {
+			check_entry(journal[i], i, undo_stack, redo_stack);
+			track(journal[i], undo_stack, redo_stack);
+		}
+
+		m_journal = std::move(journal);
+		m_undo_stack = std::move(undo_stack);
+		m_redo_stack = std::move(redo_stack);
+		m_snapshot = std::move(snapshot);
+		for (std::size_t i = 0; i < m_snapshot.m_receiver_states.size(); ++i) {
+			m_receivers[i]->load_state(m_snapshot.m_receiver_states[i]);
+		}
+		for (std::size_t i = m_snapshot.m_journal_size; i < m_journal.size(); ++i) {
+			replay(m_journal[i]);
+		}
+	}
+
+private:
+	struct Snapshot {
+		std::size_t m_journal_size = 0;
+		std::vector<std::int64_t> m_receiver_states;
+	};
+
+	[[noreturn]] static void fail(const std::string& message) {
+		throw std::runtime_error("CommandHistory::recover: " + message);
+	}
+
+	Snapshot read_snapshot(std::istream& in) const {
+		std::uint64_t journal_size = 0;
+		std::uint64_t receiver_count = 0;
+		read_value(in, journal_size);
+		read_value(in, receiver_count);
+		if (!in) {
+			fail("snapshot is truncated");
+		}
+		if (receiver_count != m_receivers.size()) {
+			fail("snapshot has " + std::to_string(receiver_count) + " receivers, " + std::to_string(m_receivers.size()) + " are registered");
+		}
+		Snapshot snapshot;
+		snapshot.m_journal_size = static_cast<std::size_t>(journal_size);
+		snapshot.m_receiver_states.resize(m_receivers.size());
+		in.read(reinterpret_cast<char*>(snapshot.m_receiver_states.data()), static_cast<std::streamsize>(m_receivers.size() * sizeof(std::int64_t)));
+		if (!in) {
+			fail("snapshot is truncated");
+		}
+		return snapshot;
+	}
+
+	// Fixed-size entries: read straight into the journal in large blocks
+	static std::vector<JournalEntry> read_journal(std::istream& in) {
+		const std::size_t block_entries = 65536;
+		std::vector<JournalEntry> journal;
+		for (;;) {
+			const std::size_t old_size = journal.size();
+			journal.resize(old_size + block_entries);
+			in.read(reinterpret_cast<char*>(journal.data() + old_size), static_cast<std::streamsize>(block_entries * sizeof(JournalEntry)));
+			const std::size_t bytes_read = static_cast<std::size_t>(in.gcount());
+			const std::size_t entries_read = bytes_read / sizeof(JournalEntry);
+			journal.resize(old_size + entries_read);
+			if (bytes_read % sizeof(JournalEntry) != 0) {
+				fail("journal ends with a partial entry after " + std::to_string(journal.size()) + " entries");
+			}
+			if (entries_read < block_entries) {
+				return journal;
+			}
+		}
+	}
+
+	// An entry must name a registered receiver and a known action, and an
+	// undo/redo must match the entry on top of its stack
+	void check_entry(const JournalEntry& entry, std::size_t index, const std::vector<JournalEntry>& undo_stack, const std::vector<JournalEntry>& redo_stack) const {
+		const std::string where = "entry " + std::to_string(index) + ": ";
+		if (entry.m_receiver_id >= m_receivers.size()) {
+			fail(where + "unknown receiver id " + std::to_string(entry.m_receiver_id));
+		}
+		const std::vector<JournalEntry>* stack = nullptr;
+		switch (entry.m_action) {
+		case JournalAction::Execute:
+			return;
+		case JournalAction::Undo:
+			stack = &undo_stack;
+			break;
+		case JournalAction::Redo:
+			stack = &redo_stack;
+			break;
+		default:
+			fail(where + "unknown action " + std::to_string(static_cast<int>(entry.m_action)));
+		}
+		if (stack->empty()) {
+			fail(where + "nothing to " + (entry.m_action == JournalAction::Undo ? "undo" : "redo"));
+		}
+		const JournalEntry& top = stack->back();
+		if (top.m_receiver_id != entry.m_receiver_id || top.m_opcode != entry.m_opcode || top.m_argument != entry.m_argument) {
+			fail(where + "does not match the command it undoes/redoes");
+		}
+	}
+
+	void append(const JournalEntry& entry) {
+		m_journal.push_back(entry);
+		if (m_journal_stream != nullptr) {
+			m_journal_stream->write(reinterpret_cast<const char*>(&entry), sizeof(JournalEntry));
+		}
+		track(entry, m_undo_stack, m_redo_stack);
+		if (m_snapshot_interval != 0 && m_journal.size() % m_snapshot_interval == 0) {
+			m_snapshot = capture_snapshot();
+		}
+	}
+
+	// Undo/redo bookkeeping shared by live execution and recovery.  undo(),
+	// redo() and check_entry() make sure the stack being popped is not empty.
+	static void track(const JournalEntry& entry, std::vector<JournalEntry>& undo_stack, std::vector<JournalEntry>& redo_stack) {
+		JournalEntry forward = entry;
+		forward.m_action = JournalAction::Execute;
+		switch (entry.m_action) {
+		case JournalAction::Execute:
+			undo_stack.push_back(forward);
+			redo_stack.clear();
+			break;
+		case JournalAction::Undo:
+			undo_stack.pop_back();
+			redo_stack.push_back(forward);
+			break;
+		case JournalAction::Redo:
+			redo_stack.pop_back();
+			undo_stack.push_back(forward);
+			break;
+		}
+	}
+
+	// Applies an entry that check_entry() has already accepted
+	void replay(const JournalEntry& entry) {
+		IJournaledReceiver* receiver = m_receivers[entry.m_receiver_id];
+		if (entry.m_action == JournalAction::Undo) {
+			receiver->revert(entry.m_opcode, entry.m_argument);
+		} else {
+			receiver->apply(entry.m_opcode, entry.m_argument);
+		}
+	}
+
+	Snapshot capture_snapshot() const {
+		Snapshot snapshot;
+		snapshot.m_journal_size = m_journal.size();
+		snapshot.m_receiver_states.reserve(m_receivers.size());
+		for (const IJournaledReceiver* receiver : m_receivers) {
+			snapshot.m_receiver_states.push_back(receiver->save_state());
+		}
+		return snapshot;
+	}
+
+	template <typename T>
+	static void write_value(std::ostream& out, const T& value) {
+		out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template <typename T>
+	static void write_vector(std::ostream& out, const std::vector<T>& values) {
+		write_value(out, static_cast<std::uint64_t>(values.size()));
+		out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+	}
+
+	template <typename T>
+	static void read_value(std::istream& in, T& value) {
+		in.read(reinterpret_cast<char*>(&value), sizeof(T));
+	}
+
+	const std::size_t m_snapshot_interval;
+	std::ostream* m_journal_stream;
+
+	std::vector<IJournaledReceiver*> m_receivers;
+	std::vector<JournalEntry> m_journal;
+	std::vector<JournalEntry> m_undo_stack;
+	std::vector<JournalEntry> m_redo_stack;
+	Snapshot m_snapshot;
+};
+
+
+// ------------ Receivers -------------
+class DimmerLight : public IJournaledReceiver {
+public:
+	enum Opcode : std::uint16_t {
+		Brighten,
+		Dim
+	};
+
+	void apply(std::uint16_t opcode, std::int64_t argument) override {
+		m_level += opcode == Brighten ? argument : -argument;
+	}
+	void revert(std::uint16_t opcode, std::int64_t argument) override {
+		m_level -= opcode == Brighten ? argument : -argument;
+	}
+	std::int64_t save_state() const override {
+		return m_level;
+	}
+	void load_state(std::int64_t state) override {
+		m_level = state;
+	}
+	std::int64_t get_level() const {
+		return m_level;
+	}
+private:
+	std::int64_t m_level = 0;
+};
+
+
+// ------------- Client -------------
+inline void command_3() {
+
+	DimmerLight kitchen_light;
+	std::stringstream journal_file;
+	std::stringstream snapshot_file;
+
+	{
+		CommandHistory history{ 100000, &journal_file };
+		const std::uint32_t kitchen_id = history.add_receiver(&kitchen_light);
+
+		history.execute(JournaledCommand{ &kitchen_light, kitchen_id, DimmerLight::Brighten, 50 });
+		history.execute(JournaledCommand{ &kitchen_light, kitchen_id, DimmerLight::Dim, 20 });
+		print("Level after brighten/dim: " + std::to_string(kitchen_light.get_level()));
+
+		history.undo();
+		print("Level after undo: " + std::to_string(kitchen_light.get_level()));
+
+		history.redo();
+		print("Level after redo: " + std::to_string(kitchen_light.get_level()));
+
+		// Build up a long history
+		for (int i = 0; i < 1000000; ++i) {
+			history.execute(JournaledCommand{ &kitchen_light, kitchen_id, i % 2 == 0 ? DimmerLight::Brighten : DimmerLight::Dim, 1 });
+		}
+		history.undo();
+		print("Level before restart: " + std::to_string(kitchen_light.get_level()));
+
+		// Unregistered receiver ids are rejected before anything runs
+		DimmerLight unregistered_light;
+		try {
+			history.execute(JournaledCommand{ &unregistered_light, kitchen_id + 1, DimmerLight::Brighten, 1 });
+		} catch (const std::invalid_argument& error) {
+			print(error.what());
+		}
+
+		history.save_snapshot(snapshot_file);
+	}
+
+	// "Restart": fresh receiver, recovered from the snapshot and journal
+	DimmerLight restarted_light;
+	CommandHistory restarted_history{ 100000 };
+	restarted_history.add_receiver(&restarted_light);
+
+	auto start = std::chrono::steady_clock::now();
+	restarted_history.recover(journal_file, &snapshot_file);
+	auto snapshot_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+	print("Level after recovery: " + std::to_string(restarted_light.get_level()) + " (" + std::to_string(snapshot_time.count()) + " us)"
+		+ (restarted_light.get_level() == kitchen_light.get_level() ? ", matches" : ", MISMATCH"));
+
+	// Full replay without a snapshot
+	journal_file.clear();
+	journal_file.seekg(0);
+	DimmerLight replayed_light;
+	CommandHistory replayed_history{ 0 };
+	replayed_history.add_receiver(&replayed_light);
+
+	start = std::chrono::steady_clock::now();
+	replayed_history.recover(journal_file);
+	auto replay_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+	print("Level after full replay of " + std::to_string(replayed_history.get_journal().size()) + " entries: " + std::to_string(replayed_light.get_level()) + " (" + std::to_string(replay_time.count()) + " us)"
+		+ (replayed_light.get_level() == kitchen_light.get_level() ? ", matches" : ", MISMATCH"));
+
+	// A history that never takes interval snapshots can still save one
+	DimmerLight hall_light;
+	std::stringstream hall_journal;
+	std::stringstream hall_snapshot;
+	CommandHistory hall_history{ 0, &hall_journal };
+	const std::uint32_t hall_id = hall_history.add_receiver(&hall_light);
+	hall_history.execute(JournaledCommand{ &hall_light, hall_id, DimmerLight::Brighten, 30 });
+	hall_history.save_snapshot(hall_snapshot);
+	hall_history.execute(JournaledCommand{ &hall_light, hall_id, DimmerLight::Dim, 5 });
+
+	DimmerLight restarted_hall_light;
+	CommandHistory restarted_hall_history{ 0 };
+	restarted_hall_history.add_receiver(&restarted_hall_light);
+	restarted_hall_history.recover(hall_journal, &hall_snapshot);
+	print("Hall level " + std::to_string(hall_light.get_level()) + ", after snapshot + journal recovery " + std::to_string(restarted_hall_light.get_level())
+		+ (restarted_hall_light.get_level() == hall_light.get_level() ? ", matches" : ", MISMATCH"));
+
+	// A journal cut off mid-entry is rejected before any receiver changes
+	// (and leaves the recovered history as it was)
+	std::stringstream truncated_journal{ journal_file.str().substr(0, 5 * sizeof(JournalEntry) + 3) };
+	try {
+		restarted_hall_history.recover(truncated_journal);
+	} catch (const std::runtime_error& error) {
+		print(std::string{ error.what() } + " (level still " + std::to_string(restarted_hall_light.get_level())
+			+ ", journal still " + std::to_string(restarted_hall_history.get_journal().size()) + " entries)");
+	}
+}
@@ -0,0 +1,232 @@
+#pragma once
+#include "Print.hpp"
+#include "Trace.hpp"
+#include "Command.hpp"
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Concept From: Head First Design Patterns
+// Example in C++ written by: Paul Burgess
+
+// Allocation-Free Commands
+// The commands in Command.hpp are created with 'new', copy their receiver and
+// are called through a vtable.  CommandFn is a command stored by value: the
+// receiver/action binding lives in a small inline buffer inside the CommandFn
+// itself (like std::function, but it never allocates).  CommandFns can be
+// created on hot paths and kept side by side in a std::vector.
+
+// Bindings that do not fit the buffer are rejected at compile time instead of
+// silently falling back to the heap.
+
+
+// -------------- Command --------------
+class CommandFn {
+
+public:
+	// Room for a receiver pointer plus a member function pointer (or any small
+	// lambda)
+	static constexpr std::size_t inline_capacity = 3 * sizeof(void*);
+
+	CommandFn() = default;
+
+	template <typename Callable, typename = std::enable_if_t<!std::is_same<std::decay_t<Callable>, CommandFn>::value>>
+	CommandFn(Callable&& callable) {
+		using Stored = std::decay_t<Callable>;
+		static_assert(sizeof(Stored) <= inline_capacity, "Binding is too large for CommandFn's inline storage");
+		static_assert(alignof(Stored) <= alignof(std::max_align_t), "Binding is over-aligned for CommandFn's inline storage");
+		static_assert(std::is_nothrow_move_constructible<Stored>::value, "Binding must be nothrow move constructible");
+
+		::new (static_cast<void*>(m_storage)) Stored(std::forward<Callable>(callable));
+		m_operations = &operations_for<Stored>;
+	}
+
+	CommandFn(CommandFn&& rhs) noexcept {
+		move_from(rhs);
+	}
+
+	CommandFn& operator=(CommandFn&& rhs) noexcept {
+		if (this != &rhs) {
+			reset();
+			move_from(rhs);
+		}
+		return *this;
+	}
+
+	CommandFn(const CommandFn&) = delete;
+	CommandFn& operator=(const CommandFn&) = delete;
+
+	~CommandFn() {
+		reset();
+	}
+
+	// Throws std::bad_function_call when empty, like std::function
+	void execute() const {
+		if (m_operations == nullptr) {
+			throw std::bad_function_call{};
+		}
+		m_operations->m_execute(m_storage);
+	}
+
+	explicit operator bool() const {
+		return m_operations != nullptr;
+	}
+
+private:
+	// One table per stored type (a hand-rolled vtable that lives next to the
+	// data instead of behind a heap pointer)
+	struct Operations {
+		void (*m_execute)(const void* storage);
+		void (*m_move)(void* destination, void* source);
+		void (*m_destroy)(void* storage);
+	};
+
+	template <typename Stored>
+	static constexpr Operations operations_for{
+		[](const void* storage) {
+			(*static_cast<const Stored*>(storage))();
+		},
+		[](void* destination, void* source) {
+			::new (destination) Stored(std::move(*static_cast<Stored*>(source)));
+			static_cast<Stored*>(source)->~Stored();
+		},
+		[](void* storage) {
+			static_cast<Stored*>(storage)->~Stored();
+		}
+	};
+
+	void move_from(CommandFn& rhs) {
+		if (rhs.m_operations != nullptr) {
+			rhs.m_operations->m_move(m_storage, rhs.m_storage);
+			m_operations = rhs.m_operations;
+			rhs.m_operations = nullptr;
+		}
+	}
+
+	void reset() {
+		if (m_operations != nullptr) {
+			m_operations->m_destroy(m_storage);
+			m_operations = nullptr;
+		}
+	}
+
+	const Operations* m_operations = nullptr;
+	alignas(std::max_align_t) unsigned char m_storage[inline_capacity];
+};
+
+
+// ---------- Receiver Bindings ----------
+// Binds a receiver (by pointer, not by copy) to one of its member functions.
+// The function is a template argument, so the call is direct.
+template <auto Action, typename Receiver>
+CommandFn make_command(const Receiver* receiver) {
+	return CommandFn{ [receiver]() {
+		(receiver->*Action)();
+	} };
+}
+
+
+// ------------ Invoker ------------
+// An empty slot does nothing (the "no command" of Head First's remote)
+class RemoteControlFn {
+public:
+	void set_command(CommandFn command) {
+		m_command_slot = std::move(command);
+	}
+	void press_button() const {
+		TRACE_SPAN("RemoteControlFn::press_button");
+		if (m_command_slot) {
+			m_command_slot.execute();
+		}
+	}
+private:
+	CommandFn m_command_slot;
+};
+
+
+// ------------- Benchmark -------------
+// Creates and executes 'count' commands each way with printing disabled.
+// Returns the elapsed nanoseconds for {virtual Command, CommandFn}.
+inline std::pair<long long, long long> benchmark_command_fn(std::size_t count) {
+
+	const Light light;
+	const GarageDoor garage_door;
+	const bool was_printing = print_enabled();
+	print_enabled() = false;
+
+	auto start = std::chrono::steady_clock::now();
+	{
+		std::vector<std::unique_ptr<Command>> commands;
+		commands.reserve(count);
+		for (std::size_t i = 0; i < count; ++i) {
+			if (i % 2 == 0) {
+				commands.push_back(std::make_unique<LightOnCommand>(light));
+			} else {
+				commands.push_back(std::make_unique<GarageDoorOpenCommand>(garage_door));
+			}
+		}
+		for (const auto& command : commands) {
+			command->execute();
+		}
+	}
+	const auto virtual_time = std::chrono::steady_clock::now() - start;
+
+	start = std::chrono::steady_clock::now();
+	{
+		std::vector<CommandFn> commands;
+		commands.reserve(count);
+		for (std::size_t i = 0; i < count; ++i) {
+			if (i % 2 == 0) {
+				commands.push_back(make_command<&Light::turn_on>(&light));
+			} else {
+				commands.push_back(make_command<&GarageDoor::open>(&garage_door));
+			}
+		}
+		for (const auto& command : commands) {
+			command.execute();
+		}
+	}
+	const auto command_fn_time = std::chrono::steady_clock::now() - start;
+
+	print_enabled() = was_printing;
+	return {
+		std::chrono::duration_cast<std::chrono::nanoseconds>(virtual_time).count(),
+		std::chrono::duration_cast<std::chrono::nanoseconds>(command_fn_time).count()
+	};
+}
+
+
+// ------------- Client -------------
+inline void command_4() {
+
+	const Light light;
+	const GarageDoor garage_door;
+	RemoteControlFn remote_control;
+
+	// Nothing assigned yet: pressing the button does nothing
+	remote_control.press_button();
+
+	remote_control.set_command(make_command<&Light::turn_on>(&light));
+	remote_control.press_button();
+
+	remote_control.set_command(make_command<&GarageDoor::open>(&garage_door));
+	remote_control.press_button();
+
+	// Any small callable works too
+	remote_control.set_command([&garage_door]() {
+		garage_door.close();
+	});
+	remote_control.press_button();
+
+	const std::size_t count = 1000000;
+	const auto timings = benchmark_command_fn(count);
+	print("Create + execute " + std::to_string(count) + " commands");
+	print("  virtual Command: " + std::to_string(timings.first / 1000) + " us");
+	print("  CommandFn:       " + std::to_string(timings.second / 1000) + " us");
+}
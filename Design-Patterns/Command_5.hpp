@@ -0,0 +1,233 @@
+#pragma once
+#include "Print.hpp"
+#include "Trace.hpp"
+#include "Command.hpp"
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Concept From: Head First Design Patterns
+// Example in C++ written by: Paul Burgess
+
+// Macro Commands and Coalescing
+// A macro command is a command made of other commands.  Executing it executes
+// each of its commands in order (undo runs them backwards).
+
+// Before building a macro, a list of commands can be "coalesced":
+//   1) Commands that set the same piece of receiver state overwrite each
+//      other, so only the last one needs to run (open -> close -> open
+//      becomes open).
+//   2) The remaining commands are grouped by receiver, so each receiver is
+//      driven in one run instead of being revisited again and again.
+// Grouping assumes commands on different receivers are independent.  Commands
+// on the same receiver keep their relative order.
+
+
+// ---------- Command Interface ----------
+class CoalescableCommand : public Command {
+public:
+	static constexpr int no_state_group = -1;
+
+	// Which receiver the command acts on
+	virtual const void* get_receiver() const = 0;
+
+	// Commands on the same receiver with the same state group overwrite each
+	// other (e.g. open() and close() both set the door position).  Commands
+	// without a state group are always kept.
+	virtual int get_state_group() const {
+		return no_state_group;
+	}
+};
+
+
+// -------------- Commands --------------
+// Unlike the commands in Command.hpp, these hold their receiver by pointer so
+// commands for the same receiver can be recognized
+enum DeviceStateGroup : int {
+	DoorPosition,
+	LightPower
+};
+
+class DoorOpenCommand : public CoalescableCommand {
+public:
+	DoorOpenCommand(const GarageDoor* garage_door)
+		:m_garage_door{ garage_door } {
+	}
+	void execute() const override {
+		m_garage_door->open();
+	}
+	void undo() const override {
+		m_garage_door->close();
+	}
+	const void* get_receiver() const override {
+		return m_garage_door;
+	}
+	int get_state_group() const override {
+		return DoorPosition;
+	}
+private:
+	const GarageDoor* m_garage_door;
+};
+
+class DoorCloseCommand : public CoalescableCommand {
+public:
+	DoorCloseCommand(const GarageDoor* garage_door)
+		:m_garage_door{ garage_door } {
+	}
+	void execute() const override {
+		m_garage_door->close();
+	}
+	void undo() const override {
+		m_garage_door->open();
+	}
+	const void* get_receiver() const override {
+		return m_garage_door;
+	}
+	int get_state_group() const override {
+		return DoorPosition;
+	}
+private:
+	const GarageDoor* m_garage_door;
+};
+
+class LightSwitchCommand : public CoalescableCommand {
+public:
+	LightSwitchCommand(const Light* light, bool turn_on)
+		:m_light{ light },
+		m_turn_on{ turn_on } {
+	}
+	void execute() const override {
+		m_turn_on ? m_light->turn_on() : m_light->turn_off();
+	}
+	void undo() const override {
+		m_turn_on ? m_light->turn_off() : m_light->turn_on();
+	}
+	const void* get_receiver() const override {
+		return m_light;
+	}
+	int get_state_group() const override {
+		return LightPower;
+	}
+private:
+	const Light* m_light;
+	bool m_turn_on;
+};
+
+
+// ---------- Macro Command ----------
+// Does not own its commands (like RemoteControl)
+class MacroCommand : public Command {
+public:
+	MacroCommand(std::vector<const Command*> commands)
+		:m_commands{ std::move(commands) } {
+	}
+	void execute() const override {
+		TRACE_SPAN("MacroCommand::execute");
+		for (const Command* command : m_commands) {
+			command->execute();
+		}
+	}
+	void undo() const override {
+		TRACE_SPAN("MacroCommand::undo");
+		for (auto it = m_commands.rbegin(); it != m_commands.rend(); ++it) {
+			(*it)->undo();
+		}
+	}
+	std::size_t size() const {
+		return m_commands.size();
+	}
+private:
+	std::vector<const Command*> m_commands;
+};
+
+
+// ---------- Coalescing ----------
+inline std::vector<const Command*> coalesce_commands(const std::vector<const CoalescableCommand*>& commands) {
+
+	// 1) Walk backwards: the first command seen for a (receiver, state group)
+	//    is the last one that would run, so it is the only one kept
+	struct StateKey {
+		const void* m_receiver;
+		int m_state_group;
+		bool operator==(const StateKey& rhs) const {
+			return m_receiver == rhs.m_receiver && m_state_group == rhs.m_state_group;
+		}
+	};
+	struct StateKeyHash {
+		std::size_t operator()(const StateKey& key) const {
+			return std::hash<const void*>{}(key.m_receiver) ^ (static_cast<std::size_t>(key.m_state_group) * 0x9E3779B9u);
+		}
+	};
+	std::unordered_set<StateKey, StateKeyHash> seen_state;
+	std::vector<bool> keep(commands.size(), true);
+	for (std::size_t i = commands.size(); i-- > 0;) {
+		const int state_group = commands[i]->get_state_group();
+		if (state_group == CoalescableCommand::no_state_group) {
+			continue;
+		}
+		if (!seen_state.insert(StateKey{ commands[i]->get_receiver(), state_group }).second) {
+			keep[i] = false;
+		}
+	}
+
+	// 2) Group the survivors by receiver, in order of each receiver's first
+	//    appearance
+	std::unordered_map<const void*, std::size_t> receiver_group;
+	std::vector<std::vector<const Command*>> groups;
+	for (std::size_t i = 0; i < commands.size(); ++i) {
+		if (!keep[i]) {
+			continue;
+		}
+		const auto inserted = receiver_group.emplace(commands[i]->get_receiver(), groups.size());
+		if (inserted.second) {
+			groups.emplace_back();
+		}
+		groups[inserted.first->second].push_back(commands[i]);
+	}
+
+	std::vector<const Command*> coalesced;
+	for (const auto& group : groups) {
+		coalesced.insert(coalesced.end(), group.begin(), group.end());
+	}
+	return coalesced;
+}
+
+inline MacroCommand make_coalesced_macro(const std::vector<const CoalescableCommand*>& commands) {
+	return MacroCommand{ coalesce_commands(commands) };
+}
+
+
+// ------------- Client -------------
+inline void command_5() {
+
+	const GarageDoor left_door;
+	const GarageDoor right_door;
+	const Light porch_light;
+
+	const DoorOpenCommand open_left{ &left_door };
+	const DoorCloseCommand close_left{ &left_door };
+	const DoorOpenCommand open_right{ &right_door };
+	const LightSwitchCommand porch_on{ &porch_light, true };
+	const LightSwitchCommand porch_off{ &porch_light, false };
+
+	// Requests as they arrived (interleaved, with redundant toggles)
+	const std::vector<const CoalescableCommand*> requests{
+		&open_left, &porch_on, &close_left, &open_right, &porch_off, &open_left, &porch_on
+	};
+
+	print("Without coalescing:");
+	const MacroCommand plain_macro{ std::vector<const Command*>(requests.begin(), requests.end()) };
+	plain_macro.execute();
+
+	print("\nWith coalescing:");
+	const MacroCommand coalesced_macro = make_coalesced_macro(requests);
+	coalesced_macro.execute();
+	print(std::to_string(plain_macro.size()) + " commands reduced to " + std::to_string(coalesced_macro.size()));
+
+	print("\nUndo:");
+	coalesced_macro.undo();
+}
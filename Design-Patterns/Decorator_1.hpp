@@ -1,5 +1,6 @@
 #pragma once
 #include "Print.hpp"
+#include "Trace.hpp"
 #include <string>
 #include <iostream>
 
@@ -48,6 +49,7 @@ public:
 	}
 
 	float get_cost() const override {
+		TRACE_SPAN("Espresso::get_cost");
 		return m_cost;
 	}
 };
@@ -66,6 +68,7 @@ public:
 	}
 
 	float get_cost() const override {
+		TRACE_SPAN("HouseBlend::get_cost");
 		return m_cost;
 	}
 };
@@ -87,6 +90,7 @@ public:
 	}
 
 	float get_cost() const override {
+		TRACE_SPAN("SprinklesDecorator::get_cost");
 		return m_consumable->get_cost() + m_cost;
 	}
 
@@ -109,6 +113,7 @@ public:
 	}
 
 	float get_cost() const override {
+		TRACE_SPAN("WhippedCreamDecorator::get_cost");
 		return m_consumable->get_cost() + m_cost;
 	}
 
@@ -130,6 +135,7 @@ public:
 	}
 
 	float get_cost() const override {
+		TRACE_SPAN("CherryDecorator::get_cost");
 		return m_consumable->get_cost() + m_cost;
 	}
 
@@ -1,5 +1,6 @@
 #pragma once
 #include "Print.hpp"
+#include "Trace.hpp"
 
 // Concept From: Refactor Guru Design Patterns Book
 // Example in C++ written by: Paul Burgess
@@ -65,9 +66,11 @@ public:
 class VictorianFurnitureFactory : public FurnitureFactory {
 public:
 	Chair* create_chair() const override {
+		TRACE_SPAN("VictorianFurnitureFactory::create_chair");
 		return new VictorianChair;
 	}
 	CoffeeTable* create_coffee_table() const override {
+		TRACE_SPAN("VictorianFurnitureFactory::create_coffee_table");
 		return new VictorianCoffeeTable;
 	}
 };
@@ -76,9 +79,11 @@ public:
 class ModernFurnitureFactory : public FurnitureFactory {
 public:
 	Chair* create_chair() const override {
+		TRACE_SPAN("ModernFurnitureFactory::create_chair");
 		return new ModernChair;
 	}
 	CoffeeTable* create_coffee_table() const override {
+		TRACE_SPAN("ModernFurnitureFactory::create_coffee_table");
 		return new ModernCoffeeTable;
 	}
 };
@@ -1,5 +1,6 @@
 #pragma once
 #include "Print.hpp"
+#include "Trace.hpp"
 
 // Concept From: Refactor Guru Design Patterns Book
 // Example in C++ written by: Paul Burgess
@@ -46,6 +47,7 @@ public:
 	virtual ~TransportCreator() = default;
 
 	Transport* create_and_test_transportation() {
+		TRACE_SPAN("TransportCreator::create_and_test_transportation");
 
 		Transport* transport_type = create_transportation();
 		
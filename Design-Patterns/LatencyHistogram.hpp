@@ -0,0 +1,181 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <vector>
+
+// Example in C++ written by: Paul Burgess
+
+// Latency Histogram
+// Records latencies (any integer unit, usually nanoseconds) into log-linear
+// buckets, the same layout HdrHistogram uses: every power-of-two range is cut
+// into 64 equal sub-buckets, so any recorded value is kept to within about
+// 1.6% (two significant digits) from 1 ns to hours, in a fixed 30 KB array.
+// Recording is a couple of shifts and one increment.
+
+// write_percentile_distribution() prints the table HdrHistogram's
+// outputPercentileDistribution() prints, so the output can be pasted into
+// the usual HDR histogram plotters.
+
+
+class LatencyHistogram {
+
+public:
+	LatencyHistogram()
+		:m_counts(bucket_count, 0) {
+	}
+
+	void record(std::uint64_t value) {
+		++m_counts[bucket_index(value)];
+		++m_total_count;
+		m_min = std::min(m_min, value);
+		m_max = std::max(m_max, value);
+		m_sum += static_cast<double>(value);
+		m_sum_of_squares += static_cast<double>(value) * static_cast<double>(value);
+	}
+
+	void add(const LatencyHistogram& other) {
+		for (std::size_t i = 0; i < bucket_count; ++i) {
+			m_counts[i] += other.m_counts[i];
+		}
+		m_total_count += other.m_total_count;
+		m_min = std::min(m_min, other.m_min);
+		m_max = std::max(m_max, other.m_max);
+		m_sum += other.m_sum;
+		m_sum_of_squares += other.m_sum_of_squares;
+	}
+
+	void reset() {
+		std::fill(m_counts.begin(), m_counts.end(), 0);
+		m_total_count = 0;
+		m_min = UINT64_MAX;
+		m_max = 0;
+		m_sum = 0.0;
+		m_sum_of_squares = 0.0;
+	}
+
+	// Highest value (to bucket precision) that 'percentile' percent of the
+	// recorded values are less than or equal to
+	std::uint64_t value_at_percentile(double percentile) const {
+		if (m_total_count == 0) {
+			return 0;
+		}
+		const double clamped = std::clamp(percentile, 0.0, 100.0);
+		const std::uint64_t wanted = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(clamped / 100.0 * static_cast<double>(m_total_count))));
+		std::uint64_t seen = 0;
+		for (std::size_t i = 0; i < bucket_count; ++i) {
+			seen += m_counts[i];
+			if (seen >= wanted) {
+				return std::min(highest_equivalent_value(i), m_max);
+			}
+		}
+		return m_max;
+	}
+
+	std::uint64_t get_total_count() const {
+		return m_total_count;
+	}
+
+	std::uint64_t get_min() const {
+		return m_total_count == 0 ? 0 : m_min;
+	}
+
+	std::uint64_t get_max() const {
+		return m_max;
+	}
+
+	double get_mean() const {
+		return m_total_count == 0 ? 0.0 : m_sum / static_cast<double>(m_total_count);
+	}
+
+	double get_standard_deviation() const {
+		if (m_total_count == 0) {
+			return 0.0;
+		}
+		const double mean = get_mean();
+		return std::sqrt(std::max(0.0, m_sum_of_squares / static_cast<double>(m_total_count) - mean * mean));
+	}
+
+	// HdrHistogram percentile distribution.  Values are divided by
+	// 'value_scale' (1000.0 prints nanoseconds as microseconds).
+	void write_percentile_distribution(std::ostream& out, double value_scale = 1.0, int ticks_per_half_distance = 5) const {
+		const auto flags = out.flags();
+		const auto precision = out.precision();
+		out << std::fixed;
+		out << std::setw(12) << "Value" << " " << std::setw(14) << "Percentile" << " " << std::setw(10) << "TotalCount" << " " << std::setw(14) << "1/(1-Percentile)" << "\n\n";
+
+		if (m_total_count != 0) {
+			double percentile = 0.0;
+			for (;;) {
+				const std::uint64_t value = value_at_percentile(percentile);
+				const std::uint64_t count = count_at_or_below(value);
+				out << std::setw(12) << std::setprecision(3) << static_cast<double>(value) / value_scale << " "
+					<< std::setw(14) << std::setprecision(12) << (count == m_total_count ? 1.0 : percentile / 100.0) << " "
+					<< std::setw(10) << count;
+				if (count != m_total_count) {
+					out << " " << std::setw(14) << std::setprecision(2) << 1.0 / (1.0 - percentile / 100.0);
+				}
+				out << "\n";
+				if (count == m_total_count) {
+					break;
+				}
+				// Halve the step every time the remaining distance to 100% halves
+				const double half_distance = std::pow(2.0, std::floor(std::log2(100.0 / (100.0 - percentile))) + 1.0);
+				percentile += 100.0 / half_distance / ticks_per_half_distance;
+			}
+		}
+
+		out << std::setprecision(3)
+			<< "#[Mean    = " << std::setw(12) << get_mean() / value_scale << ", StdDeviation   = " << std::setw(12) << get_standard_deviation() / value_scale << "]\n"
+			<< "#[Max     = " << std::setw(12) << static_cast<double>(m_max) / value_scale << ", Total count    = " << std::setw(12) << m_total_count << "]\n"
+			<< "#[Buckets = " << std::setw(12) << bucket_count / sub_bucket_half_count << ", SubBuckets     = " << std::setw(12) << sub_bucket_count << "]\n";
+		out.flags(flags);
+		out.precision(precision);
+	}
+
+private:
+	// Values below 128 get a bucket each; above that every power of two is
+	// split into 64 sub-buckets
+	static constexpr std::size_t sub_bucket_count = 128;
+	static constexpr std::size_t sub_bucket_half_count = 64;
+	static constexpr int sub_bucket_bits = 7;
+	static constexpr std::size_t bucket_count = sub_bucket_count + (64 - sub_bucket_bits) * sub_bucket_half_count;
+
+	static std::size_t bucket_index(std::uint64_t value) {
+		if (value < sub_bucket_count) {
+			return static_cast<std::size_t>(value);
+		}
+		const int shift = std::bit_width(value) - sub_bucket_bits;
+		return sub_bucket_count + static_cast<std::size_t>(shift - 1) * sub_bucket_half_count
+			+ static_cast<std::size_t>((value >> shift) - sub_bucket_half_count);
+	}
+
+	static std::uint64_t highest_equivalent_value(std::size_t index) {
+		if (index < sub_bucket_count) {
+			return index;
+		}
+		const std::size_t shift = (index - sub_bucket_count) / sub_bucket_half_count + 1;
+		const std::uint64_t sub_bucket = (index - sub_bucket_count) % sub_bucket_half_count + sub_bucket_half_count;
+		return ((sub_bucket + 1) << shift) - 1;
+	}
+
+	std::uint64_t count_at_or_below(std::uint64_t value) const {
+		const std::size_t last = bucket_index(value);
+		std::uint64_t count = 0;
+		for (std::size_t i = 0; i <= last; ++i) {
+			count += m_counts[i];
+		}
+		return count;
+	}
+
+	std::vector<std::uint64_t> m_counts;
+	std::uint64_t m_total_count = 0;
+	std::uint64_t m_min = UINT64_MAX;
+	std::uint64_t m_max = 0;
+	double m_sum = 0.0;
+	double m_sum_of_squares = 0.0;
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include "Print.hpp"
+#include "Trace.hpp"
 #include <list>
 #include <string>
 #include <vector>
@@ -106,6 +107,7 @@ public:
 	}
 
 	void notify_all_observers() const override {
+		TRACE_SPAN("WeatherDataSubject::notify_all_observers");
 		for (auto& observer : m_observer_list) {
 			observer->update();
 		}
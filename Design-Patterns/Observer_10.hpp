@@ -0,0 +1,211 @@
+#pragma once
+#include "Print.hpp"
+#include "Trace.hpp"
+#include "AllocationHook.hpp"
+#include "LatencyHistogram.hpp"
+#include "Observer_2.hpp"
+#include "Observer_4.hpp"
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#endif
+
+// Concept From: Head First Design Patterns
+// Example in C++ written by: Paul Burgess
+
+// Real-Time (Allocation-Free) Observer
+// A control loop cannot afford a heap allocation per cycle: malloc can take a
+// lock or a page fault at the worst moment.  The raw-pointer observer
+// (Observer_2.hpp) can run allocation-free after setup:
+//   - set_observer_capacity() reserves the observer storage up front, so
+//     registering never allocates (it throws when the capacity is used up)
+//   - set_measurements() and the displays' update() only copy floats
+//   - ControlLoopDisplayRaw formats display() into a fixed buffer with
+//     std::to_chars instead of building std::strings with std::to_string
+// Optionally, lock_process_memory() pins the process's pages in RAM
+// (mlockall), so the loop cannot page-fault either.
+
+// run_real_time_loop() checks the claim: it counts heap allocations on the
+// loop thread in steady state (with the hook from AllocationHook.hpp) and
+// records every notify into a preallocated latency histogram, reporting the
+// far tail (p99.9 and p99.99), which is what a control loop has to budget for.
+// Tests/RealTimeAllocationCheck.cpp runs the same loop under ctest and fails
+// if it allocates.
+
+
+// ---------- Memory Locking ----------
+// Returns false when locking is not available or not permitted (it usually
+// needs CAP_IPC_LOCK or a large enough RLIMIT_MEMLOCK)
+inline bool lock_process_memory() {
+#if defined(__unix__) || defined(__APPLE__)
+	return ::mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+#else
+	return false;
+#endif
+}
+
+inline void unlock_process_memory() {
+#if defined(__unix__) || defined(__APPLE__)
+	::munlockall();
+#endif
+}
+
+// Touches the stack the loop will use so its pages are mapped before the
+// loop starts
+inline void prefault_stack() {
+	volatile unsigned char stack[64 * 1024];
+	for (std::size_t i = 0; i < sizeof(stack); i += 4096) {
+		stack[i] = 0;
+	}
+}
+
+
+// --------------------- Allocation-Free Display ---------------------
+class ControlLoopDisplayRaw : public IDisplayElementRaw, public IObserverRaw {
+
+public:
+	ControlLoopDisplayRaw(WeatherDataSubjectRaw* weather_data_subject)
+		:m_snapshot{ weather_data_subject->get_snapshot() },
+		m_weather_data_subject{ weather_data_subject } {
+
+		m_weather_data_subject->register_observer(this);
+	}
+
+	void update() override {
+		m_snapshot = m_weather_data_subject->get_snapshot();
+	}
+
+	// Formats into a member buffer: no std::string, no allocation
+	void display() const override {
+		std::size_t length = 0;
+		append(length, "T=");
+		append_number(length, m_snapshot.m_temperature);
+		append(length, " H=");
+		append_number(length, m_snapshot.m_humidity);
+		append(length, " P=");
+		append_number(length, m_snapshot.m_pressure);
+		print(std::string_view{ m_text, length });
+	}
+
+private:
+	void append(std::size_t& length, std::string_view text) const {
+		for (const char c : text) {
+			if (length < sizeof(m_text)) {
+				m_text[length++] = c;
+			}
+		}
+	}
+
+	void append_number(std::size_t& length, float value) const {
+		const std::to_chars_result result = std::to_chars(m_text + length, m_text + sizeof(m_text), value, std::chars_format::fixed, 2);
+		if (result.ec == std::errc{}) {
+			length = static_cast<std::size_t>(result.ptr - m_text);
+		}
+	}
+
+	WeatherSnapshot m_snapshot;
+	WeatherDataSubjectRaw* m_weather_data_subject;
+	mutable char m_text[96] = {};
+};
+
+
+// ---------- Real-Time Loop ----------
+struct RealTimeLoopResult {
+	std::size_t m_cycles = 0;
+	AllocationCounts m_steady_state_allocations;
+	LatencyHistogram m_notify_latency;  // ns per set_measurements() (all observers)
+};
+
+// Runs 'warmup_cycles' untimed cycles, then 'cycles' measured ones.  The
+// histogram is built before the measured cycles, so they allocate nothing
+// of their own.
+inline RealTimeLoopResult run_real_time_loop(WeatherDataSubjectRaw& subject, SequenceWeatherDataRaw& sensor, std::size_t warmup_cycles, std::size_t cycles) {
+	using Clock = std::chrono::steady_clock;
+
+	RealTimeLoopResult result;
+	result.m_cycles = cycles;
+	prefault_stack();
+
+	for (std::size_t i = 0; i < warmup_cycles; ++i) {
+		sensor.set_base(static_cast<float>(i & 0xFFFF));
+		subject.set_measurements();
+	}
+
+	const AllocationCounts before = get_thread_allocation_counts();
+	for (std::size_t i = 0; i < cycles; ++i) {
+		sensor.set_base(static_cast<float>(i & 0xFFFF));
+		const Clock::time_point start = Clock::now();
+		subject.set_measurements();
+		const Clock::time_point end = Clock::now();
+		result.m_notify_latency.record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+	}
+	result.m_steady_state_allocations = get_thread_allocation_counts() - before;
+	return result;
+}
+
+
+// ---------------- Example ----------------
+inline void observer_10() {
+
+	if (!allocation_hook_installed()) {
+		print("Allocation hook not compiled in (define DESIGN_PATTERNS_ALLOCATION_HOOK in one source file); allocation counts are n/a");
+	}
+
+	// ----- Initialization: everything that allocates happens here -----
+	const std::size_t observer_capacity = 64;
+	SequenceWeatherDataRaw sensor;
+	WeatherDataSubjectRaw subject{ &sensor };
+	subject.set_observer_capacity(observer_capacity);
+
+	std::vector<std::unique_ptr<IObserverRaw>> observers;
+	observers.reserve(observer_capacity);
+	for (std::size_t i = 0; i < observer_capacity / 2; ++i) {
+		observers.push_back(std::make_unique<CurrentConditionsDisplayRaw>(&subject));
+		observers.push_back(std::make_unique<ControlLoopDisplayRaw>(&subject));
+	}
+	const bool memory_locked = lock_process_memory();
+	print(std::string{ "Memory locked: " } + (memory_locked ? "yes" : "no (needs CAP_IPC_LOCK or a higher RLIMIT_MEMLOCK)"));
+
+	// ----- Steady state -----
+	const RealTimeLoopResult result = run_real_time_loop(subject, sensor, 10000, 200000);
+	const LatencyHistogram& latency = result.m_notify_latency;
+	print(std::to_string(result.m_cycles) + " cycles with " + std::to_string(observer_capacity) + " observers, heap allocations in steady state: "
+		+ format_allocation_count(result.m_steady_state_allocations.m_allocations));
+	print("Notify latency (ns): p50 " + std::to_string(latency.value_at_percentile(50.0))
+		+ ", p99 " + std::to_string(latency.value_at_percentile(99.0))
+		+ ", p99.9 " + std::to_string(latency.value_at_percentile(99.9))
+		+ ", p99.99 " + std::to_string(latency.value_at_percentile(99.99))
+		+ ", max " + std::to_string(latency.get_max()));
+
+	// A full observer list refuses instead of allocating
+	ControlLoopDisplayRaw* extra = nullptr;
+	try {
+		extra = new ControlLoopDisplayRaw{ &subject };
+	} catch (const std::length_error& error) {
+		print(std::string{ "Registering observer 65: " } + error.what());
+	}
+	delete extra;
+
+	// display(): to_chars into a buffer versus std::to_string
+	AllocationCounts before = get_thread_allocation_counts();
+	static_cast<const ControlLoopDisplayRaw&>(*observers[1]).display();
+	const AllocationCounts fixed_buffer = get_thread_allocation_counts() - before;
+	before = get_thread_allocation_counts();
+	static_cast<const CurrentConditionsDisplayRaw&>(*observers[0]).display();
+	const AllocationCounts with_strings = get_thread_allocation_counts() - before;
+	print("display() allocations: fixed buffer " + format_allocation_count(fixed_buffer.m_allocations)
+		+ ", std::to_string " + format_allocation_count(with_strings.m_allocations));
+
+	if (memory_locked) {
+		unlock_process_memory();
+	}
+}
@@ -1,8 +1,14 @@
 #pragma once
 #include "Print.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
-#include <list>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 // Concept From: Head First Design Patterns
 // Example in C++ written by: Paul Burgess
@@ -12,6 +18,14 @@
 
 // This observer pattern using raw pointers.
 
+// The subject's measurements are published with a sequence lock, so readers
+// on other threads can take a consistent snapshot (temperature, humidity and
+// pressure all from the same set_measurements() call) without taking a lock.
+
+// Observers are kept in a vector.  set_observer_capacity() reserves room up
+// front and makes that a hard limit, so registering never allocates (see the
+// real-time example in Observer_10.hpp).
+
 
 // ------ Observer (the "many" in the one-to-many) relationship ------
 class IObserverRaw {
@@ -62,6 +76,14 @@ public:
 };
 
 
+// ------------------------ Snapshot ------------------------
+struct WeatherSnapshot {
+	float m_temperature;
+	float m_humidity;
+	float m_pressure;
+};
+
+
 // ------------------------ Subject (the "one") ------------------------
 class WeatherDataSubjectRaw : public ISubjectRaw {
 
@@ -74,44 +96,99 @@ public:
 	}
 
 	void register_observer(IObserverRaw* observer) override {
+		if (m_fixed_capacity && m_observer_list.size() == m_observer_list.capacity()) {
+			throw std::length_error("WeatherDataSubjectRaw: observer capacity exceeded");
+		}
 		m_observer_list.push_back(observer);
 	}
 
 	void remove_observer(IObserverRaw* observer) override {
-		m_observer_list.remove(observer);
+		m_observer_list.erase(std::remove(m_observer_list.begin(), m_observer_list.end(), observer), m_observer_list.end());
+	}
+
+	// Fixed capacity: allocates once here, then register_observer() never
+	// allocates and throws std::length_error when full
+	void set_observer_capacity(std::size_t capacity) {
+		if (capacity < m_observer_list.size()) {
+			throw std::length_error("WeatherDataSubjectRaw: capacity is below the current observer count");
+		}
+		std::vector<IObserverRaw*> observers;
+		observers.reserve(capacity);
+		observers.assign(m_observer_list.begin(), m_observer_list.end());
+		m_observer_list.swap(observers);
+		m_fixed_capacity = true;
 	}
 
 	void notify_observers() const override {
+		TRACE_SPAN("WeatherDataSubjectRaw::notify_observers");
 		for (const auto& observer : m_observer_list) {
 			observer->update();
 		}
 	}
 
+	// Only one thread may call set_measurements() at a time
 	void set_measurements() {
-		m_temperature = m_weather_data_getter->get_temperature();
-		m_humidity = m_weather_data_getter->get_humidity();
-		m_pressure = m_weather_data_getter->get_pressure();
+		publish(WeatherSnapshot{
+			m_weather_data_getter->get_temperature(),
+			m_weather_data_getter->get_humidity(),
+			m_weather_data_getter->get_pressure()
+		});
 		notify_observers();
 	}
 
+	// Sequence lock (writer side): the sequence is odd while the values are
+	// being written.  Readers that see an odd or changed sequence try again.
+	void publish(const WeatherSnapshot& snapshot) {
+		const std::uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+		m_sequence.store(sequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		m_temperature.store(snapshot.m_temperature, std::memory_order_relaxed);
+		m_humidity.store(snapshot.m_humidity, std::memory_order_relaxed);
+		m_pressure.store(snapshot.m_pressure, std::memory_order_relaxed);
+		m_sequence.store(sequence + 2, std::memory_order_release);
+	}
+
+	// All three values from the same publish(), from any thread, lock-free
+	WeatherSnapshot get_snapshot() const {
+		for (;;) {
+			const std::uint64_t before = m_sequence.load(std::memory_order_acquire);
+			if (before & 1) {
+				continue;
+			}
+			const WeatherSnapshot snapshot{
+				m_temperature.load(std::memory_order_relaxed),
+				m_humidity.load(std::memory_order_relaxed),
+				m_pressure.load(std::memory_order_relaxed)
+			};
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (m_sequence.load(std::memory_order_relaxed) == before) {
+				return snapshot;
+			}
+		}
+	}
+
+	// The single-value getters are still safe to call from any thread, but
+	// three separate calls can mix two different measurements
 	float get_temperature() const {
-		return m_temperature;
+		return m_temperature.load(std::memory_order_relaxed);
 	}
 
 	float get_humidity() const {
-		return m_humidity;
+		return m_humidity.load(std::memory_order_relaxed);
 	}
 
 	float get_pressure() const {
-		return m_pressure;
+		return m_pressure.load(std::memory_order_relaxed);
 	}
 
 private:
-	float m_temperature;
-	float m_humidity;
-	float m_pressure;
+	std::atomic<std::uint64_t> m_sequence{ 0 };
+	std::atomic<float> m_temperature;
+	std::atomic<float> m_humidity;
+	std::atomic<float> m_pressure;
 
-	std::list<IObserverRaw*> m_observer_list;
+	std::vector<IObserverRaw*> m_observer_list;
+	bool m_fixed_capacity = false;
 	const IWeatherDataGetterRaw* m_weather_data_getter;
 
 };
@@ -137,9 +214,10 @@ public:
 	}
 
 	void update() override {
-		m_temperature = m_weather_data_subject->get_temperature();
-		m_humidity = m_weather_data_subject->get_humidity();
-		m_pressure = m_weather_data_subject->get_pressure();
+		const WeatherSnapshot snapshot = m_weather_data_subject->get_snapshot();
+		m_temperature = snapshot.m_temperature;
+		m_humidity = snapshot.m_humidity;
+		m_pressure = snapshot.m_pressure;
 	}
 
 private:
@@ -165,9 +243,10 @@ public:
 	}
 
 	void update() override {
-		m_temperature = m_weather_data_subject->get_temperature();
-		m_pressure = m_weather_data_subject->get_pressure();
-		m_humidity = m_weather_data_subject->get_humidity();
+		const WeatherSnapshot snapshot = m_weather_data_subject->get_snapshot();
+		m_temperature = snapshot.m_temperature;
+		m_pressure = snapshot.m_pressure;
+		m_humidity = snapshot.m_humidity;
 	}
 
 	void display() const override {
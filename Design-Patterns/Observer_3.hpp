@@ -0,0 +1,248 @@
+#pragma once
+#include "Print.hpp"
+#include "Trace.hpp"
+#include "Observer_1.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Concept From: Head First Design Patterns
+// Example in C++ written by: Paul Burgess
+
+// Versioned (Lazy Pull) Observer
+// In Observer_1.hpp every set_measurements() call runs update() on every
+// observer.  That happens even for displays nobody will look at for minutes,
+// and even when the reading did not change.  The cost of taking in one
+// reading grows with the number of observers.
+
+// Here the subject keeps a version counter per field.  A field's version goes
+// up only when its value actually changes.  Lazy displays do not register at
+// all.  When display() is called they compare the versions they cached with
+// the subject's.  They re-pull only the fields that are stale.  Taking in a
+// reading now costs the same no matter how many displays there are.
+
+// Eager observers (IObserver from Observer_1.hpp) can still register.  They
+// are only notified when some field really changed.
+
+
+// ---------- Versioned Field ----------
+struct VersionedReading {
+	float m_value = 0.0f;
+	std::uint64_t m_version = 0;
+};
+
+
+// ------------------------ Subject (the "one") ------------------------
+class VersionedWeatherDataSubject : public ISubject {
+
+public:
+	VersionedWeatherDataSubject(const std::shared_ptr<IWeatherDataGetter>& weather_getter)
+		:m_weather_getter_ptr{ weather_getter } {
+	}
+
+	void register_observer(const std::shared_ptr<IObserver>& observer_ptr) override {
+		m_observer_list.push_back(observer_ptr);
+	}
+
+	void remove_observer(const std::shared_ptr<IObserver>& observer_ptr) override {
+		m_observer_list.remove(observer_ptr);
+	}
+
+	// Returns true when at least one field changed
+	bool set_measurements() {
+		TRACE_SPAN("VersionedWeatherDataSubject::set_measurements");
+		bool changed = store(m_temperature, m_weather_getter_ptr->get_temperature());
+		changed = store(m_humidity, m_weather_getter_ptr->get_humidity()) || changed;
+		changed = store(m_pressure, m_weather_getter_ptr->get_pressure()) || changed;
+		if (changed) {
+			++m_version;
+			notify_all_observers();
+		}
+		return changed;
+	}
+
+	void notify_all_observers() const override {
+		for (auto& observer : m_observer_list) {
+			observer->update();
+		}
+	}
+
+	const VersionedReading& get_temperature() const {
+		return m_temperature;
+	}
+
+	const VersionedReading& get_humidity() const {
+		return m_humidity;
+	}
+
+	const VersionedReading& get_pressure() const {
+		return m_pressure;
+	}
+
+	// Goes up once per set_measurements() call that changed anything.  A
+	// display whose cached version matches this is fully up to date.
+	std::uint64_t get_version() const {
+		return m_version;
+	}
+
+private:
+	static bool store(VersionedReading& reading, float value) {
+		if (reading.m_version != 0 && reading.m_value == value) {
+			return false;
+		}
+		reading.m_value = value;
+		++reading.m_version;
+		return true;
+	}
+
+	VersionedReading m_temperature;
+	VersionedReading m_humidity;
+	VersionedReading m_pressure;
+	std::uint64_t m_version = 0;
+
+	std::list<std::shared_ptr<IObserver>> m_observer_list;
+	const std::shared_ptr<IWeatherDataGetter> m_weather_getter_ptr;
+};
+
+
+// --------------------- Lazy Displays ---------------------
+// Pull on display(), not on every measurement
+class LazyCurrentConditionsDisplay : public IDisplayElement {
+
+public:
+	LazyCurrentConditionsDisplay(const std::shared_ptr<const VersionedWeatherDataSubject>& weather_data_subject_ptr)
+		:m_weather_data_subject_ptr{ weather_data_subject_ptr } {
+	}
+
+	void display() const override {
+		refresh();
+		print("Temperature: " + std::to_string(m_temperature.m_value));
+		print("Humidity: " + std::to_string(m_humidity.m_value));
+		print("Pressure: " + std::to_string(m_pressure.m_value));
+	}
+
+	// Number of fields re-pulled so far (for the example)
+	std::size_t get_pull_count() const {
+		return m_pull_count;
+	}
+
+private:
+	void refresh() const {
+		TRACE_SPAN("LazyCurrentConditionsDisplay::refresh");
+		const VersionedWeatherDataSubject& subject = *m_weather_data_subject_ptr;
+		if (subject.get_version() == m_version) {
+			return;
+		}
+		pull(m_temperature, subject.get_temperature());
+		pull(m_humidity, subject.get_humidity());
+		pull(m_pressure, subject.get_pressure());
+		m_version = subject.get_version();
+	}
+
+	void pull(VersionedReading& cached, const VersionedReading& current) const {
+		if (cached.m_version != current.m_version) {
+			cached = current;
+			++m_pull_count;
+		}
+	}
+
+	// The cache is refreshed from display(), which is const
+	mutable VersionedReading m_temperature;
+	mutable VersionedReading m_humidity;
+	mutable VersionedReading m_pressure;
+	mutable std::uint64_t m_version = 0;
+	mutable std::size_t m_pull_count = 0;
+	std::shared_ptr<const VersionedWeatherDataSubject> m_weather_data_subject_ptr;
+};
+
+// Only cares about one field, so only that field's version is checked
+class LazyTemperatureDisplay : public IDisplayElement {
+
+public:
+	LazyTemperatureDisplay(const std::shared_ptr<const VersionedWeatherDataSubject>& weather_data_subject_ptr)
+		:m_weather_data_subject_ptr{ weather_data_subject_ptr } {
+	}
+
+	void display() const override {
+		const VersionedReading& current = m_weather_data_subject_ptr->get_temperature();
+		if (current.m_version != m_temperature.m_version) {
+			m_temperature = current;
+		}
+		print("Temperature only: " + std::to_string(m_temperature.m_value));
+	}
+
+private:
+	mutable VersionedReading m_temperature;
+	std::shared_ptr<const VersionedWeatherDataSubject> m_weather_data_subject_ptr;
+};
+
+
+// --------------------- Concrete Classes ---------------------
+// Readings that can be changed between calls (WeatherDataFromDB always
+// returns the same values)
+class SimulatedWeatherData : public IWeatherDataGetter {
+public:
+	void set_readings(float temperature, float humidity, float pressure) {
+		m_temperature = temperature;
+		m_humidity = humidity;
+		m_pressure = pressure;
+	}
+
+	float get_temperature() const override {
+		return m_temperature;
+	}
+
+	float get_humidity() const override {
+		return m_humidity;
+	}
+
+	float get_pressure() const override {
+		return m_pressure;
+	}
+
+private:
+	float m_temperature = 0.0f;
+	float m_humidity = 0.0f;
+	float m_pressure = 0.0f;
+};
+
+
+// ---------------- Example ----------------
+inline void observer_3() {
+
+	std::shared_ptr<SimulatedWeatherData> sensor = std::make_shared<SimulatedWeatherData>();
+	std::shared_ptr<VersionedWeatherDataSubject> subject = std::make_shared<VersionedWeatherDataSubject>(sensor);
+
+	// Many mostly idle dashboards
+	const std::size_t display_count = 1000;
+	std::vector<std::shared_ptr<LazyCurrentConditionsDisplay>> displays;
+	for (std::size_t i = 0; i < display_count; ++i) {
+		displays.push_back(std::make_shared<LazyCurrentConditionsDisplay>(subject));
+	}
+	const LazyTemperatureDisplay temperature_display{ subject };
+
+	// Ingest a stream of readings.  Only the pressure moves; every other
+	// reading repeats the last one.
+	const std::size_t reading_count = 100000;
+	std::size_t changed_readings = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (std::size_t i = 0; i < reading_count; ++i) {
+		sensor->set_readings(91.5f, 37.45f, 88.0f + static_cast<float>(i / 1000));
+		changed_readings += subject->set_measurements() ? 1 : 0;
+	}
+	const auto ingest_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+	print("Ingested " + std::to_string(reading_count) + " readings (" + std::to_string(changed_readings)
+		+ " changed) for " + std::to_string(display_count) + " displays in " + std::to_string(ingest_time.count()) + " us");
+
+	// One dashboard is opened: it pulls what it is missing, once
+	displays.front()->display();
+	displays.front()->display();
+	print("Fields pulled by the opened display: " + std::to_string(displays.front()->get_pull_count()));
+	print("Fields pulled by an unopened display: " + std::to_string(displays.back()->get_pull_count()));
+
+	temperature_display.display();
+}
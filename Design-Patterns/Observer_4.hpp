@@ -0,0 +1,147 @@
+#pragma once
+#include "Print.hpp"
+#include "Observer_2.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Concept From: Head First Design Patterns
+// Example in C++ written by: Paul Burgess
+
+// Consistent Snapshots Under Load
+// Stress test for WeatherDataSubjectRaw::get_snapshot() (Observer_2.hpp).  One
+// writer thread calls set_measurements() as fast as it can while N reader
+// threads read the measurements back.  Every measurement the writer publishes
+// follows a rule (humidity = temperature + 1, pressure = temperature + 2), so
+// a reader can tell when it got values from two different measurements (a
+// "torn" read).
+
+// Each reader alternates between get_snapshot() and the three single-value
+// getters.  The snapshots should never be torn; the getters can be.
+
+
+// ---------- Writer Side ----------
+// Getter whose readings the writer thread sets before each set_measurements()
+class SequenceWeatherDataRaw : public IWeatherDataGetterRaw {
+public:
+	void set_base(float base) {
+		m_base = base;
+	}
+	float get_temperature() const override {
+		return m_base;
+	}
+	float get_humidity() const override {
+		return m_base + 1.0f;
+	}
+	float get_pressure() const override {
+		return m_base + 2.0f;
+	}
+private:
+	float m_base = 0.0f;
+};
+
+
+// ---------- Stress Test ----------
+struct SnapshotStressResult {
+	std::size_t m_reader_count;
+	std::uint64_t m_writes;
+	std::uint64_t m_snapshot_reads;
+	std::uint64_t m_torn_snapshots;
+	std::uint64_t m_getter_reads;
+	std::uint64_t m_torn_getter_reads;
+	double m_seconds;
+};
+
+inline bool is_consistent(float temperature, float humidity, float pressure) {
+	return humidity == temperature + 1.0f && pressure == temperature + 2.0f;
+}
+
+inline SnapshotStressResult stress_weather_snapshots(std::size_t reader_count, std::chrono::milliseconds duration) {
+
+	SequenceWeatherDataRaw sensor;
+	WeatherDataSubjectRaw subject{ &sensor };
+	std::atomic<bool> running{ true };
+	std::atomic<std::size_t> readers_ready{ 0 };
+
+	struct alignas(64) ReaderCounts {
+		std::uint64_t m_snapshot_reads = 0;
+		std::uint64_t m_torn_snapshots = 0;
+		std::uint64_t m_getter_reads = 0;
+		std::uint64_t m_torn_getter_reads = 0;
+	};
+	std::vector<ReaderCounts> counts(reader_count);
+
+	std::vector<std::thread> readers;
+	for (std::size_t i = 0; i < reader_count; ++i) {
+		readers.emplace_back([&subject, &running, &readers_ready, &counts, i]() {
+			ReaderCounts local;
+			readers_ready.fetch_add(1, std::memory_order_relaxed);
+			while (running.load(std::memory_order_relaxed)) {
+				const WeatherSnapshot snapshot = subject.get_snapshot();
+				++local.m_snapshot_reads;
+				if (!is_consistent(snapshot.m_temperature, snapshot.m_humidity, snapshot.m_pressure)) {
+					++local.m_torn_snapshots;
+				}
+
+				const float temperature = subject.get_temperature();
+				const float humidity = subject.get_humidity();
+				const float pressure = subject.get_pressure();
+				++local.m_getter_reads;
+				if (!is_consistent(temperature, humidity, pressure)) {
+					++local.m_torn_getter_reads;
+				}
+			}
+			counts[i] = local;
+		});
+	}
+	while (readers_ready.load(std::memory_order_relaxed) < reader_count) {
+		std::this_thread::yield();
+	}
+
+	// Bases stay below 2^20 so base + 2 is exact in a float
+	std::uint64_t writes = 0;
+	const auto start = std::chrono::steady_clock::now();
+	std::thread writer([&]() {
+		while (std::chrono::steady_clock::now() - start < duration) {
+			for (int i = 0; i < 256; ++i) {
+				sensor.set_base(static_cast<float>(writes & 0xFFFFF));
+				subject.set_measurements();
+				++writes;
+			}
+		}
+		running.store(false, std::memory_order_relaxed);
+	});
+	writer.join();
+	for (auto& reader : readers) {
+		reader.join();
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	SnapshotStressResult result{ reader_count, writes, 0, 0, 0, 0, seconds };
+	for (const ReaderCounts& reader_counts : counts) {
+		result.m_snapshot_reads += reader_counts.m_snapshot_reads;
+		result.m_torn_snapshots += reader_counts.m_torn_snapshots;
+		result.m_getter_reads += reader_counts.m_getter_reads;
+		result.m_torn_getter_reads += reader_counts.m_torn_getter_reads;
+	}
+	return result;
+}
+
+
+// ---------------- Example ----------------
+inline void observer_4() {
+
+	for (const std::size_t reader_count : { 1, 2, 4 }) {
+		const SnapshotStressResult result = stress_weather_snapshots(reader_count, std::chrono::milliseconds{ 300 });
+		print("1 writer, " + std::to_string(result.m_reader_count) + " reader(s):");
+		print("  writes/s:            " + std::to_string(static_cast<long long>(result.m_writes / result.m_seconds)));
+		print("  snapshot reads/s:    " + std::to_string(static_cast<long long>(result.m_snapshot_reads / result.m_seconds))
+			+ " (torn: " + std::to_string(result.m_torn_snapshots) + ")");
+		print("  getter reads/s:      " + std::to_string(static_cast<long long>(result.m_getter_reads / result.m_seconds))
+			+ " (torn: " + std::to_string(result.m_torn_getter_reads) + ")");
+	}
+}
@@ -0,0 +1,353 @@
+#pragma once
+#include "Print.hpp"
+#include "Trace.hpp"
+#include "Observer_1.hpp"
+#include "Observer_3.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Concept From: Head First Design Patterns
+// Example in C++ written by: Paul Burgess
+
+// Hierarchical (Fan-In) Observer
+// In Observer_1.hpp an observer watches one subject.  Here a regional subject
+// observes many station subjects (WeatherDataSubject) and is itself a subject
+// that dashboards, or a larger region, can observe.  Regions form a tree:
+// stations -> regions -> country.
+
+// A region keeps running sums and counts of its inputs.  When one station
+// reports, the region subtracts that station's previous reading and adds the
+// new one, so the cost does not depend on how many stations it has.
+// Regions re-publish at most once per publish interval (throttling), not on
+// every station update.
+
+// Every region is meant to be driven by one thread: the thread that calls
+// set_measurements() on its stations and publish_if_due() on the region.
+// Different regions can run on different threads in parallel.  A region that
+// observes other regions can receive updates from several threads, so each
+// region guards its sums with a mutex (uncontended for station-level regions).
+
+
+// ---------- Running Sums ----------
+struct WeatherSums {
+	double m_temperature = 0.0;
+	double m_humidity = 0.0;
+	double m_pressure = 0.0;
+	std::size_t m_count = 0;
+
+	WeatherSums& operator+=(const WeatherSums& rhs) {
+		m_temperature += rhs.m_temperature;
+		m_humidity += rhs.m_humidity;
+		m_pressure += rhs.m_pressure;
+		m_count += rhs.m_count;
+		return *this;
+	}
+
+	WeatherSums& operator-=(const WeatherSums& rhs) {
+		m_temperature -= rhs.m_temperature;
+		m_humidity -= rhs.m_humidity;
+		m_pressure -= rhs.m_pressure;
+		m_count -= rhs.m_count;
+		return *this;
+	}
+
+	double average(double sum) const {
+		return m_count == 0 ? 0.0 : sum / static_cast<double>(m_count);
+	}
+};
+
+
+// ------------------------ Regional Subject ------------------------
+class RegionalWeatherSubject : public ISubject {
+
+public:
+	using Clock = std::chrono::steady_clock;
+
+	RegionalWeatherSubject(const std::string& name, Clock::duration publish_interval)
+		:m_name{ name },
+		m_publish_interval{ publish_interval } {
+	}
+
+	// A station becomes one input of this region
+	void add_station(const std::shared_ptr<WeatherDataSubject>& station) {
+		auto link = std::make_shared<StationLink>(this, add_input(), station.get());
+		link->register_self();
+	}
+
+	// A whole region becomes one input of this region (weighted by its count)
+	void add_region(const std::shared_ptr<RegionalWeatherSubject>& region) {
+		auto link = std::make_shared<RegionLink>(this, add_input(), region.get());
+		link->register_self();
+	}
+
+	void register_observer(const std::shared_ptr<IObserver>& observer_ptr) override {
+		m_observer_list.push_back(observer_ptr);
+	}
+
+	void remove_observer(const std::shared_ptr<IObserver>& observer_ptr) override {
+		m_observer_list.remove(observer_ptr);
+	}
+
+	void notify_all_observers() const override {
+		TRACE_SPAN("RegionalWeatherSubject::notify_all_observers");
+		for (auto& observer : m_observer_list) {
+			observer->update();
+		}
+	}
+
+	// Publishes the current sums if something changed and the last publish
+	// was at least one interval ago.  Returns true when it published.
+	bool publish_if_due(Clock::time_point now) {
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			if (!m_dirty || now - m_last_publish < m_publish_interval) {
+				return false;
+			}
+			publish_locked(now);
+		}
+		notify_all_observers();
+		return true;
+	}
+
+	// Publishes now if anything changed, ignoring the interval
+	bool flush() {
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			if (!m_dirty) {
+				return false;
+			}
+			publish_locked(Clock::now());
+		}
+		notify_all_observers();
+		return true;
+	}
+
+	// The last published sums (what observers see)
+	WeatherSums get_published_sums() const {
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		return m_published;
+	}
+
+	float get_temperature() const {
+		const WeatherSums sums = get_published_sums();
+		return static_cast<float>(sums.average(sums.m_temperature));
+	}
+
+	float get_humidity() const {
+		const WeatherSums sums = get_published_sums();
+		return static_cast<float>(sums.average(sums.m_humidity));
+	}
+
+	float get_pressure() const {
+		const WeatherSums sums = get_published_sums();
+		return static_cast<float>(sums.average(sums.m_pressure));
+	}
+
+	std::size_t get_station_count() const {
+		return get_published_sums().m_count;
+	}
+
+	std::size_t get_publish_count() const {
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		return m_publish_count;
+	}
+
+	const std::string& get_name() const {
+		return m_name;
+	}
+
+private:
+	// ---------- Links (observers of the inputs) ----------
+	// The link is owned by the input's observer list and only points back at
+	// the region and the input, so there is no ownership cycle.  The region
+	// must outlive the inputs it was added to.
+	class StationLink : public IObserver, public std::enable_shared_from_this<StationLink> {
+	public:
+		StationLink(RegionalWeatherSubject* region, std::size_t input, WeatherDataSubject* station)
+			:m_region{ region },
+			m_input{ input },
+			m_station{ station } {
+		}
+		void register_self() override {
+			m_station->register_observer(shared_from_this());
+		}
+		void update() override {
+			m_region->update_input(m_input, WeatherSums{ m_station->get_temperature(), m_station->get_humidity(), m_station->get_pressure(), 1 });
+		}
+	private:
+		RegionalWeatherSubject* m_region;
+		std::size_t m_input;
+		WeatherDataSubject* m_station;
+	};
+
+	class RegionLink : public IObserver, public std::enable_shared_from_this<RegionLink> {
+	public:
+		RegionLink(RegionalWeatherSubject* region, std::size_t input, RegionalWeatherSubject* child)
+			:m_region{ region },
+			m_input{ input },
+			m_child{ child } {
+		}
+		void register_self() override {
+			m_child->register_observer(shared_from_this());
+		}
+		void update() override {
+			m_region->update_input(m_input, m_child->get_published_sums());
+		}
+	private:
+		RegionalWeatherSubject* m_region;
+		std::size_t m_input;
+		RegionalWeatherSubject* m_child;
+	};
+
+	std::size_t add_input() {
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		m_inputs.emplace_back();
+		return m_inputs.size() - 1;
+	}
+
+	// Incremental merge: remove the input's old contribution, add the new one
+	void update_input(std::size_t input, const WeatherSums& sums) {
+		TRACE_SPAN("RegionalWeatherSubject::update_input");
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		m_sums -= m_inputs[input];
+		m_sums += sums;
+		m_inputs[input] = sums;
+		m_dirty = true;
+	}
+
+	void publish_locked(Clock::time_point now) {
+		m_published = m_sums;
+		m_dirty = false;
+		m_last_publish = now;
+		++m_publish_count;
+	}
+
+	const std::string m_name;
+	const Clock::duration m_publish_interval;
+
+	mutable std::mutex m_mutex;
+	std::vector<WeatherSums> m_inputs;
+	WeatherSums m_sums;
+	WeatherSums m_published;
+	bool m_dirty = false;
+	Clock::time_point m_last_publish{};
+	std::size_t m_publish_count = 0;
+
+	std::list<std::shared_ptr<IObserver>> m_observer_list;
+};
+
+
+// --------------------- Observer (part of the "many") ---------------------
+class RegionalDashboard : public IObserver, public IDisplayElement, public std::enable_shared_from_this<RegionalDashboard> {
+
+public:
+	RegionalDashboard(const std::shared_ptr<RegionalWeatherSubject>& region_ptr)
+		:m_region_ptr{ region_ptr } {
+	}
+
+	void register_self() override {
+		m_region_ptr->register_observer(shared_from_this());
+	}
+
+	void update() override {
+		m_sums = m_region_ptr->get_published_sums();
+	}
+
+	void display() const override {
+		print(m_region_ptr->get_name() + " (" + std::to_string(m_sums.m_count) + " stations)");
+		print("  Average temperature: " + std::to_string(m_sums.average(m_sums.m_temperature)));
+		print("  Average humidity: " + std::to_string(m_sums.average(m_sums.m_humidity)));
+		print("  Average pressure: " + std::to_string(m_sums.average(m_sums.m_pressure)));
+	}
+
+private:
+	WeatherSums m_sums;
+	std::shared_ptr<RegionalWeatherSubject> m_region_ptr;
+};
+
+
+// ---------------- Example ----------------
+// One station: its subject plus the sensor it reads from
+struct Station {
+	std::shared_ptr<SimulatedWeatherData> m_sensor;
+	std::shared_ptr<WeatherDataSubject> m_subject;
+};
+
+inline void observer_5() {
+
+	const std::size_t region_count = 64;
+	const std::size_t stations_per_region = 1600; // about 100k stations
+	const std::size_t rounds = 10;
+	const auto publish_interval = std::chrono::milliseconds{ 5 };
+
+	// Build the tree: stations -> regions -> country
+	auto country = std::make_shared<RegionalWeatherSubject>("Country", publish_interval);
+	std::vector<std::shared_ptr<RegionalWeatherSubject>> regions;
+	std::vector<std::vector<Station>> stations(region_count);
+	for (std::size_t r = 0; r < region_count; ++r) {
+		regions.push_back(std::make_shared<RegionalWeatherSubject>("Region " + std::to_string(r), publish_interval));
+		for (std::size_t s = 0; s < stations_per_region; ++s) {
+			Station station;
+			station.m_sensor = std::make_shared<SimulatedWeatherData>();
+			station.m_subject = std::make_shared<WeatherDataSubject>(station.m_sensor);
+			regions.back()->add_station(station.m_subject);
+			stations[r].push_back(station);
+		}
+		country->add_region(regions.back());
+	}
+
+	auto dashboard = std::make_shared<RegionalDashboard>(country);
+	dashboard->register_self();
+
+	// One worker per hardware thread; each owns a contiguous block of regions
+	const std::size_t worker_count = std::max<std::size_t>(1, std::min<std::size_t>(std::thread::hardware_concurrency(), region_count));
+	const auto start = std::chrono::steady_clock::now();
+	std::atomic<std::size_t> workers_done{ 0 };
+	std::vector<std::thread> workers;
+	for (std::size_t w = 0; w < worker_count; ++w) {
+		workers.emplace_back([&, w]() {
+			for (std::size_t round = 0; round < rounds; ++round) {
+				for (std::size_t r = w; r < region_count; r += worker_count) {
+					for (std::size_t s = 0; s < stations_per_region; ++s) {
+						const float offset = static_cast<float>((r + s + round) % 10);
+						stations[r][s].m_sensor->set_readings(60.0f + offset, 40.0f + offset, 1000.0f + offset);
+						stations[r][s].m_subject->set_measurements();
+					}
+					regions[r]->publish_if_due(std::chrono::steady_clock::now());
+				}
+			}
+			workers_done.fetch_add(1, std::memory_order_release);
+		});
+	}
+
+	// This thread drives the top of the tree
+	while (workers_done.load(std::memory_order_acquire) < worker_count) {
+		country->publish_if_due(std::chrono::steady_clock::now());
+		std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+	}
+	for (auto& worker : workers) {
+		worker.join();
+	}
+
+	// Push out whatever the throttle held back
+	for (const auto& region : regions) {
+		region->flush();
+	}
+	country->flush();
+	const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	const std::size_t updates = region_count * stations_per_region * rounds;
+	print(std::to_string(updates) + " station updates on " + std::to_string(worker_count) + " worker(s): "
+		+ std::to_string(static_cast<long long>(updates / elapsed)) + " updates/s");
+	print("Regional publishes: " + std::to_string(regions.front()->get_publish_count()) + " per region"
+		+ ", country publishes: " + std::to_string(country->get_publish_count()));
+	dashboard->display();
+}
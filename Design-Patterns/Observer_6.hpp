@@ -0,0 +1,469 @@
+#pragma once
+#include "Print.hpp"
+#include "Trace.hpp"
+#include "Observer_1.hpp"
+#include "Observer_3.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define DESIGN_PATTERNS_HAS_SHM 1
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#else
+#define DESIGN_PATTERNS_HAS_SHM 0
+#endif
+
+// Concept From: Head First Design Patterns
+// Example in C++ written by: Paul Burgess
+
+// Cross-Process Observer (Shared Memory Transport)
+// In Observer_1.hpp the subject calls update() on observers in its own
+// process.  Here one of the subject's observers is a publisher that copies
+// each measurement into a ring buffer in a POSIX shared-memory segment.  In
+// another process, a proxy reads the ring and replays each measurement into a
+// local WeatherDataSubject ("mirror").  Displays in that process register with
+// the mirror exactly as they would with the real subject, so
+// CurrentConditionsDisplay works unchanged.
+
+// The ring is lock-free with one writer and any number of readers.  Each slot
+// carries a sequence number (odd while it is being written), and readers
+// check it before and after copying a record.  The writer never waits for
+// readers.  A reader that falls more than one ring behind skips ahead and
+// counts the records it lost.  Delivery is by polling (no sockets, no system
+// calls on the hot path).
+
+// POSIX only (shm_open/mmap).  On other platforms observer_6() just says so.
+
+
+#if DESIGN_PATTERNS_HAS_SHM
+
+// ---------- Shared Memory Layout ----------
+// Everything in the segment is a lock-free atomic, which is also address-free,
+// so it works when mapped at different addresses in different processes
+struct alignas(64) ShmWeatherSlot {
+	std::atomic<std::uint64_t> m_sequence;   // 2n+1 while record n is written, 2n+2 once it is complete
+	std::atomic<std::int64_t> m_publish_ns;  // steady_clock time of the publish (same clock in every process)
+	std::atomic<float> m_temperature;
+	std::atomic<float> m_humidity;
+	std::atomic<float> m_pressure;
+};
+
+struct ShmWeatherRingHeader {
+	static constexpr std::uint32_t expected_magic = 0x57544852u; // "WTHR"
+
+	std::atomic<std::uint32_t> m_magic;                   // written last, with release, by the creator
+	std::uint64_t m_capacity;
+	alignas(64) std::atomic<std::uint64_t> m_published;   // records published so far
+	alignas(64) std::atomic<std::uint64_t> m_subscribers; // proxies that have attached
+};
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "Shared-memory ring needs lock-free 32-bit atomics");
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Shared-memory ring needs lock-free 64-bit atomics");
+static_assert(std::atomic<float>::is_always_lock_free, "Shared-memory ring needs lock-free float atomics");
+
+
+// ---------- Measurement Record ----------
+struct WeatherRecord {
+	std::uint64_t m_index;
+	std::int64_t m_publish_ns;
+	float m_temperature;
+	float m_humidity;
+	float m_pressure;
+};
+
+inline std::int64_t steady_now_ns() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+// ---------- Shared Memory Ring ----------
+// Owns one mapping of the segment.  The creating side also unlinks the name
+// when it goes away.
+class ShmWeatherRing {
+
+public:
+	// capacity must be a power of two
+	static std::unique_ptr<ShmWeatherRing> create(const std::string& name, std::size_t capacity) {
+		if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+			throw std::invalid_argument("ShmWeatherRing capacity must be a power of two");
+		}
+		const int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+		if (fd < 0) {
+			throw std::runtime_error("shm_open(" + name + ") failed: " + std::strerror(errno));
+		}
+		const std::size_t size = segment_size(capacity);
+		if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+			const int error = errno;
+			::close(fd);
+			::shm_unlink(name.c_str());
+			throw std::runtime_error("ftruncate(" + name + ") failed: " + std::strerror(error));
+		}
+
+		std::unique_ptr<ShmWeatherRing> ring{ new ShmWeatherRing(name, fd, size, true) };
+		ShmWeatherRingHeader* header = ::new (ring->m_memory) ShmWeatherRingHeader{};
+		header->m_capacity = capacity;
+		for (std::size_t i = 0; i < capacity; ++i) {
+			::new (&ring->get_slots()[i]) ShmWeatherSlot{};
+		}
+		header->m_published.store(0, std::memory_order_relaxed);
+		header->m_subscribers.store(0, std::memory_order_relaxed);
+		// The magic goes in last so an opener never sees a half-built ring
+		header->m_magic.store(ShmWeatherRingHeader::expected_magic, std::memory_order_release);
+		return ring;
+	}
+
+	static std::unique_ptr<ShmWeatherRing> open(const std::string& name) {
+		const int fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+		if (fd < 0) {
+			throw std::runtime_error("shm_open(" + name + ") failed: " + std::strerror(errno));
+		}
+		struct stat info {};
+		if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(ShmWeatherRingHeader)) {
+			::close(fd);
+			throw std::runtime_error("Shared memory segment " + name + " is not a weather ring");
+		}
+
+		std::unique_ptr<ShmWeatherRing> ring{ new ShmWeatherRing(name, fd, static_cast<std::size_t>(info.st_size), false) };
+		const ShmWeatherRingHeader& header = ring->get_header();
+		// Pairs with the release store in create(): once the magic is seen, the
+		// rest of the header is too
+		if (header.m_magic.load(std::memory_order_acquire) != ShmWeatherRingHeader::expected_magic || segment_size(header.m_capacity) != ring->m_size) {
+			throw std::runtime_error("Shared memory segment " + name + " is not a weather ring");
+		}
+		return ring;
+	}
+
+	ShmWeatherRing(const ShmWeatherRing&) = delete;
+	ShmWeatherRing& operator=(const ShmWeatherRing&) = delete;
+
+	~ShmWeatherRing() {
+		::munmap(m_memory, m_size);
+		::close(m_fd);
+		if (m_owner) {
+			::shm_unlink(m_name.c_str());
+		}
+	}
+
+	// Writer side (one writer per ring)
+	void publish(float temperature, float humidity, float pressure) {
+		ShmWeatherRingHeader& header = get_header();
+		const std::uint64_t index = header.m_published.load(std::memory_order_relaxed);
+		ShmWeatherSlot& slot = get_slots()[index & (header.m_capacity - 1)];
+
+		slot.m_sequence.store(2 * index + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		slot.m_publish_ns.store(steady_now_ns(), std::memory_order_relaxed);
+		slot.m_temperature.store(temperature, std::memory_order_relaxed);
+		slot.m_humidity.store(humidity, std::memory_order_relaxed);
+		slot.m_pressure.store(pressure, std::memory_order_relaxed);
+		slot.m_sequence.store(2 * index + 2, std::memory_order_release);
+
+		header.m_published.store(index + 1, std::memory_order_release);
+	}
+
+	ShmWeatherRingHeader& get_header() {
+		return *static_cast<ShmWeatherRingHeader*>(m_memory);
+	}
+
+	ShmWeatherSlot* get_slots() {
+		return reinterpret_cast<ShmWeatherSlot*>(static_cast<unsigned char*>(m_memory) + slots_offset());
+	}
+
+private:
+	ShmWeatherRing(const std::string& name, int fd, std::size_t size, bool owner)
+		:m_name{ name },
+		m_fd{ fd },
+		m_size{ size },
+		m_owner{ owner } {
+		m_memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (m_memory == MAP_FAILED) {
+			const int error = errno;
+			::close(fd);
+			if (owner) {
+				::shm_unlink(name.c_str());
+			}
+			throw std::runtime_error("mmap(" + name + ") failed: " + std::strerror(error));
+		}
+	}
+
+	static constexpr std::size_t slots_offset() {
+		return (sizeof(ShmWeatherRingHeader) + alignof(ShmWeatherSlot) - 1) / alignof(ShmWeatherSlot) * alignof(ShmWeatherSlot);
+	}
+
+	static std::size_t segment_size(std::uint64_t capacity) {
+		return slots_offset() + static_cast<std::size_t>(capacity) * sizeof(ShmWeatherSlot);
+	}
+
+	std::string m_name;
+	int m_fd;
+	std::size_t m_size;
+	bool m_owner;
+	void* m_memory = nullptr;
+};
+
+
+// ---------- Reader ----------
+// One reader's position in the ring.  Starts at the newest record at the time
+// it attaches.
+class ShmWeatherReader {
+
+public:
+	explicit ShmWeatherReader(ShmWeatherRing& ring)
+		:m_ring{ ring },
+		m_next{ ring.get_header().m_published.load(std::memory_order_acquire) } {
+	}
+
+	// Returns false when no new record is available
+	bool try_read(WeatherRecord& record) {
+		ShmWeatherRingHeader& header = m_ring.get_header();
+		const std::uint64_t capacity = header.m_capacity;
+		for (;;) {
+			const std::uint64_t published = header.m_published.load(std::memory_order_acquire);
+			if (m_next >= published) {
+				return false;
+			}
+			if (published - m_next > capacity) {
+				skip_to(published - capacity);
+			}
+
+			const ShmWeatherSlot& slot = m_ring.get_slots()[m_next & (capacity - 1)];
+			const std::uint64_t before = slot.m_sequence.load(std::memory_order_acquire);
+			if (before != 2 * m_next + 2) {
+				// The writer has already lapped this slot
+				skip_to(m_next + 1);
+				continue;
+			}
+			record.m_index = m_next;
+			record.m_publish_ns = slot.m_publish_ns.load(std::memory_order_relaxed);
+			record.m_temperature = slot.m_temperature.load(std::memory_order_relaxed);
+			record.m_humidity = slot.m_humidity.load(std::memory_order_relaxed);
+			record.m_pressure = slot.m_pressure.load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (slot.m_sequence.load(std::memory_order_relaxed) != before) {
+				skip_to(m_next + 1);
+				continue;
+			}
+			++m_next;
+			return true;
+		}
+	}
+
+	std::uint64_t get_lost_count() const {
+		return m_lost;
+	}
+
+private:
+	void skip_to(std::uint64_t next) {
+		m_lost += next - m_next;
+		m_next = next;
+	}
+
+	ShmWeatherRing& m_ring;
+	std::uint64_t m_next;
+	std::uint64_t m_lost = 0;
+};
+
+
+// --------------------- Publisher (sending process) ---------------------
+// Just another observer of the real subject
+class ShmWeatherPublisher : public IObserver, public std::enable_shared_from_this<ShmWeatherPublisher> {
+
+public:
+	ShmWeatherPublisher(const std::shared_ptr<WeatherDataSubject>& weather_data_subject_ptr, const std::string& name, std::size_t capacity = 1024)
+		:m_ring{ ShmWeatherRing::create(name, capacity) },
+		m_weather_data_subject_ptr{ weather_data_subject_ptr } {
+	}
+
+	void register_self() override {
+		if (auto subject = m_weather_data_subject_ptr.lock()) {
+			subject->register_observer(shared_from_this());
+		}
+	}
+
+	void update() override {
+		TRACE_SPAN("ShmWeatherPublisher::update");
+		if (auto subject = m_weather_data_subject_ptr.lock()) {
+			m_ring->publish(subject->get_temperature(), subject->get_humidity(), subject->get_pressure());
+		}
+	}
+
+	std::uint64_t get_subscriber_count() const {
+		return m_ring->get_header().m_subscribers.load(std::memory_order_acquire);
+	}
+
+private:
+	std::unique_ptr<ShmWeatherRing> m_ring;
+	// weak: the subject already owns this observer
+	std::weak_ptr<WeatherDataSubject> m_weather_data_subject_ptr;
+};
+
+
+// --------------------- Proxy (receiving process) ---------------------
+// Replays records into a local mirror subject.  Local displays register with
+// get_subject() and never know the data crossed a process boundary.
+class ShmObserverProxy {
+
+public:
+	explicit ShmObserverProxy(const std::string& name)
+		:m_ring{ ShmWeatherRing::open(name) },
+		m_reader{ *m_ring },
+		m_received{ std::make_shared<SimulatedWeatherData>() },
+		m_mirror{ std::make_shared<WeatherDataSubject>(m_received) } {
+		m_ring->get_header().m_subscribers.fetch_add(1, std::memory_order_acq_rel);
+	}
+
+	ShmObserverProxy(const ShmObserverProxy&) = delete;
+	ShmObserverProxy& operator=(const ShmObserverProxy&) = delete;
+
+	~ShmObserverProxy() {
+		m_ring->get_header().m_subscribers.fetch_sub(1, std::memory_order_acq_rel);
+	}
+
+	std::shared_ptr<WeatherDataSubject>& get_subject() {
+		return m_mirror;
+	}
+
+	// Delivers up to 'max_records' new records to the local observers.
+	// Returns how many were delivered.
+	std::size_t poll(std::size_t max_records = static_cast<std::size_t>(-1)) {
+		TRACE_SPAN("ShmObserverProxy::poll");
+		std::size_t delivered = 0;
+		while (delivered < max_records && m_reader.try_read(m_last_record)) {
+			m_received->set_readings(m_last_record.m_temperature, m_last_record.m_humidity, m_last_record.m_pressure);
+			m_mirror->set_measurements();
+			++delivered;
+		}
+		return delivered;
+	}
+
+	const WeatherRecord& get_last_record() const {
+		return m_last_record;
+	}
+
+	std::uint64_t get_lost_count() const {
+		return m_reader.get_lost_count();
+	}
+
+private:
+	std::unique_ptr<ShmWeatherRing> m_ring;
+	ShmWeatherReader m_reader;
+	WeatherRecord m_last_record{};
+	std::shared_ptr<SimulatedWeatherData> m_received;
+	std::shared_ptr<WeatherDataSubject> m_mirror;
+};
+
+#endif
+
+
+// ---------------- Example ----------------
+inline void observer_6() {
+
+#if DESIGN_PATTERNS_HAS_SHM
+	const std::string name = "/design_patterns_weather_" + std::to_string(::getpid());
+	const std::size_t record_count = 20000;
+
+	std::shared_ptr<SimulatedWeatherData> sensor = std::make_shared<SimulatedWeatherData>();
+	std::shared_ptr<WeatherDataSubject> subject = std::make_shared<WeatherDataSubject>(sensor);
+	std::shared_ptr<ShmWeatherPublisher> publisher = std::make_shared<ShmWeatherPublisher>(subject, name);
+	publisher->register_self();
+
+	const pid_t child = ::fork();
+	if (child == 0) {
+		// ----- Receiving process -----
+		int exit_code = 0;
+		try {
+			ShmObserverProxy proxy{ name };
+			std::shared_ptr<CurrentConditionsDisplay> display = std::make_shared<CurrentConditionsDisplay>(proxy.get_subject());
+			display->register_self();
+
+			std::vector<std::int64_t> latencies;
+			latencies.reserve(record_count);
+			std::size_t idle_polls = 0;
+			while (latencies.size() + proxy.get_lost_count() < record_count) {
+				if (proxy.poll(1) == 1) {
+					latencies.push_back(steady_now_ns() - proxy.get_last_record().m_publish_ns);
+					idle_polls = 0;
+				} else if (++idle_polls > 1000) {
+					// Spin briefly, then let other work (maybe the publisher) run
+					std::this_thread::yield();
+				}
+			}
+
+			display->display();
+			std::sort(latencies.begin(), latencies.end());
+			if (!latencies.empty()) {
+				print("Received " + std::to_string(latencies.size()) + " records in another process (lost "
+					+ std::to_string(proxy.get_lost_count()) + ")");
+				print("Latency median: " + std::to_string(latencies[latencies.size() / 2]) + " ns, p99: "
+					+ std::to_string(latencies[latencies.size() * 99 / 100]) + " ns");
+			}
+			proxy.get_subject()->remove_observer(display);
+		} catch (const std::exception& error) {
+			print(std::string{ "Receiver failed: " } + error.what());
+			exit_code = 1;
+		}
+		std::cout.flush();
+		::_exit(exit_code);
+	}
+	if (child < 0) {
+		print("fork() failed");
+		subject->remove_observer(publisher);
+		return;
+	}
+
+	// ----- Sending process -----
+	// Wait for the receiver to attach, but give up if it exits first (it
+	// could not open the ring) or takes too long
+	int status = 0;
+	const auto attach_deadline = std::chrono::steady_clock::now() + std::chrono::seconds{ 5 };
+	while (publisher->get_subscriber_count() == 0) {
+		const pid_t exited = ::waitpid(child, &status, WNOHANG);
+		if (exited == child || exited < 0) {
+			print("Receiver exited before attaching" + (exited == child && WIFEXITED(status) ? " (exit code " + std::to_string(WEXITSTATUS(status)) + ")" : std::string{}));
+			subject->remove_observer(publisher);
+			return;
+		}
+		if (std::chrono::steady_clock::now() > attach_deadline) {
+			print("Receiver did not attach within 5 s");
+			::kill(child, SIGKILL);
+			::waitpid(child, &status, 0);
+			subject->remove_observer(publisher);
+			return;
+		}
+		std::this_thread::yield();
+	}
+	for (std::size_t i = 0; i < record_count; ++i) {
+		sensor->set_readings(70.0f + static_cast<float>(i % 20), 40.0f, 1010.0f);
+		subject->set_measurements();
+		// Publish at a steady rate rather than flooding the ring
+		const auto next = std::chrono::steady_clock::now() + std::chrono::microseconds{ 20 };
+		while (std::chrono::steady_clock::now() < next) {
+			std::this_thread::yield();
+		}
+	}
+
+	::waitpid(child, &status, 0);
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+		print("Receiver failed");
+	}
+	subject->remove_observer(publisher);
+#else
+	print("The shared-memory transport needs POSIX shared memory (shm_open)");
+#endif
+}
@@ -0,0 +1,431 @@
+#pragma once
+#include "Print.hpp"
+#include "Trace.hpp"
+#include "Observer_1.hpp"
+#include "Observer_2.hpp"
+#include "Observer_3.hpp"
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Concept From: Head First Design Patterns
+// Example in C++ written by: Paul Burgess
+
+// Awaitable Observer (C++20 Coroutines)
+// With update() callbacks (Observer_1.hpp), a reaction that spans several
+// measurements ("three rising readings in a row") has to be written as a
+// state machine spread over calls.  Here a coroutine just loops:
+//
+//     while (auto measurement = co_await feed.next_measurement(stop)) { ... }
+//
+// AwaitableWeatherFeed is an ordinary IObserver, so it registers with an
+// existing WeatherDataSubject next to the usual displays.  On update() it
+// hands the reading to every suspended coroutine and schedules them on an
+// executor, which resumes them later (not inside set_measurements()).
+
+// Waiting is cancellable with a std::stop_token: the wait then ends with an
+// empty optional and the coroutine finishes normally.  close() ends every wait
+// the same way.
+
+// A suspended coroutine costs one frame (a few hundred bytes) from a pooled
+// allocator, so 100k waiting consumers are cheap compared to 100k threads.
+
+// Everything runs on one thread: the thread that calls set_measurements(),
+// runs the executor, and requests stops.  Frames are pooled per thread.
+
+
+// ---------- Frame Pool ----------
+// Free lists of fixed-size blocks carved from large chunks.  All frames of
+// one coroutine function have the same size, so blocks are reused exactly.
+class CoroutineFramePool {
+
+public:
+	CoroutineFramePool() = default;
+	CoroutineFramePool(const CoroutineFramePool&) = delete;
+	CoroutineFramePool& operator=(const CoroutineFramePool&) = delete;
+
+	void* allocate(std::size_t size) {
+		const std::size_t bucket = bucket_for(size);
+		if (bucket >= bucket_count) {
+			++m_live_frames;
+			return ::operator new(size);
+		}
+		++m_live_frames;
+		if (FreeBlock* block = m_free_lists[bucket]) {
+			m_free_lists[bucket] = block->m_next;
+			return block;
+		}
+		const std::size_t block_size = (bucket + 1) * granularity;
+		if (m_chunk_remaining < block_size) {
+			m_chunks.push_back(std::make_unique<unsigned char[]>(chunk_size));
+			m_chunk_cursor = m_chunks.back().get();
+			m_chunk_remaining = chunk_size;
+		}
+		void* block = m_chunk_cursor;
+		m_chunk_cursor += block_size;
+		m_chunk_remaining -= block_size;
+		return block;
+	}
+
+	void deallocate(void* frame, std::size_t size) noexcept {
+		--m_live_frames;
+		const std::size_t bucket = bucket_for(size);
+		if (bucket >= bucket_count) {
+			::operator delete(frame);
+			return;
+		}
+		FreeBlock* block = static_cast<FreeBlock*>(frame);
+		block->m_next = m_free_lists[bucket];
+		m_free_lists[bucket] = block;
+	}
+
+	std::size_t get_live_frames() const {
+		return m_live_frames;
+	}
+
+	std::size_t get_reserved_bytes() const {
+		return m_chunks.size() * chunk_size;
+	}
+
+	static CoroutineFramePool& get_instance() {
+		thread_local CoroutineFramePool pool;
+		return pool;
+	}
+
+private:
+	struct FreeBlock {
+		FreeBlock* m_next;
+	};
+
+	static constexpr std::size_t granularity = 64;
+	static constexpr std::size_t bucket_count = 32;  // frames up to 2 KB are pooled
+	static constexpr std::size_t chunk_size = 1 << 20;
+
+	static std::size_t bucket_for(std::size_t size) {
+		return (size + granularity - 1) / granularity - 1;
+	}
+
+	FreeBlock* m_free_lists[bucket_count] = {};
+	std::vector<std::unique_ptr<unsigned char[]>> m_chunks;
+	unsigned char* m_chunk_cursor = nullptr;
+	std::size_t m_chunk_remaining = 0;
+	std::size_t m_live_frames = 0;
+};
+
+
+// ---------- Coroutine Type ----------
+// Fire and forget: starts right away, frees its frame when it finishes
+class WeatherTask {
+
+public:
+	struct promise_type {
+		WeatherTask get_return_object() noexcept {
+			return {};
+		}
+		std::suspend_never initial_suspend() noexcept {
+			return {};
+		}
+		std::suspend_never final_suspend() noexcept {
+			return {};
+		}
+		void return_void() noexcept {
+		}
+		void unhandled_exception() noexcept {
+			std::terminate();
+		}
+
+		static void* operator new(std::size_t size) {
+			return CoroutineFramePool::get_instance().allocate(size);
+		}
+		static void operator delete(void* frame, std::size_t size) noexcept {
+			CoroutineFramePool::get_instance().deallocate(frame, size);
+		}
+	};
+};
+
+
+// ---------- Executor ----------
+// Resumes scheduled coroutines when run() is called
+class RunQueueExecutor {
+
+public:
+	void schedule(std::coroutine_handle<> handle) {
+		m_queue.push_back(handle);
+	}
+
+	// Runs until nothing is scheduled.  Returns the number of resumptions.
+	std::size_t run() {
+		TRACE_SPAN("RunQueueExecutor::run");
+		std::size_t resumed = 0;
+		while (!m_queue.empty()) {
+			m_running.swap(m_queue);
+			for (std::coroutine_handle<> handle : m_running) {
+				handle.resume();
+			}
+			resumed += m_running.size();
+			m_running.clear();
+		}
+		return resumed;
+	}
+
+private:
+	// Two buffers so coroutines can schedule more work while a batch runs
+	std::vector<std::coroutine_handle<>> m_queue;
+	std::vector<std::coroutine_handle<>> m_running;
+};
+
+
+// ---------- Awaiter ----------
+class AwaitableWeatherFeed;
+
+// Lives in the waiting coroutine's frame and links itself into the feed's
+// waiter list, so waiting allocates nothing
+class MeasurementAwaiter {
+
+public:
+	MeasurementAwaiter(AwaitableWeatherFeed& feed, std::stop_token stop)
+		:m_feed{ feed },
+		m_stop{ std::move(stop) } {
+	}
+
+	MeasurementAwaiter(const MeasurementAwaiter&) = delete;
+	MeasurementAwaiter& operator=(const MeasurementAwaiter&) = delete;
+
+	bool await_ready() const noexcept;
+	void await_suspend(std::coroutine_handle<> handle);
+
+	// Empty when the wait was cancelled or the feed was closed
+	std::optional<WeatherSnapshot> await_resume() noexcept {
+		m_stop_callback.reset();
+		return m_result;
+	}
+
+private:
+	friend class AwaitableWeatherFeed;
+
+	struct Cancel {
+		MeasurementAwaiter* m_awaiter;
+		void operator()() const noexcept;
+	};
+
+	AwaitableWeatherFeed& m_feed;
+	std::stop_token m_stop;
+	std::optional<std::stop_callback<Cancel>> m_stop_callback;
+	std::coroutine_handle<> m_handle;
+	std::optional<WeatherSnapshot> m_result;
+
+	// Intrusive doubly linked list so a cancelled waiter unlinks in O(1)
+	MeasurementAwaiter* m_prev = nullptr;
+	MeasurementAwaiter* m_next = nullptr;
+	bool m_linked = false;
+};
+
+
+// --------------------- Observer / Awaitable Source ---------------------
+class AwaitableWeatherFeed : public IObserver, public std::enable_shared_from_this<AwaitableWeatherFeed> {
+
+public:
+	AwaitableWeatherFeed(const std::shared_ptr<WeatherDataSubject>& weather_data_subject_ptr, RunQueueExecutor& executor)
+		:m_weather_data_subject_ptr{ weather_data_subject_ptr },
+		m_executor{ executor } {
+	}
+
+	void register_self() override {
+		if (auto subject = m_weather_data_subject_ptr.lock()) {
+			subject->register_observer(shared_from_this());
+		}
+	}
+
+	// Hands the reading to every waiting coroutine and schedules them
+	void update() override {
+		TRACE_SPAN("AwaitableWeatherFeed::update");
+		if (auto subject = m_weather_data_subject_ptr.lock()) {
+			wake_all(WeatherSnapshot{ subject->get_temperature(), subject->get_humidity(), subject->get_pressure() });
+		}
+	}
+
+	// co_await feed.next_measurement(stop) suspends until the next update()
+	MeasurementAwaiter next_measurement(std::stop_token stop = {}) {
+		return MeasurementAwaiter{ *this, std::move(stop) };
+	}
+
+	// Ends every current and future wait with an empty optional
+	void close() {
+		m_closed = true;
+		wake_all(std::nullopt);
+	}
+
+	bool is_closed() const {
+		return m_closed;
+	}
+
+	std::size_t get_waiting_count() const {
+		return m_waiting_count;
+	}
+
+private:
+	friend class MeasurementAwaiter;
+
+	void link(MeasurementAwaiter* awaiter) {
+		awaiter->m_prev = nullptr;
+		awaiter->m_next = m_head;
+		if (m_head) {
+			m_head->m_prev = awaiter;
+		}
+		m_head = awaiter;
+		awaiter->m_linked = true;
+		++m_waiting_count;
+	}
+
+	void unlink(MeasurementAwaiter* awaiter) {
+		if (awaiter->m_prev) {
+			awaiter->m_prev->m_next = awaiter->m_next;
+		} else {
+			m_head = awaiter->m_next;
+		}
+		if (awaiter->m_next) {
+			awaiter->m_next->m_prev = awaiter->m_prev;
+		}
+		awaiter->m_linked = false;
+		--m_waiting_count;
+	}
+
+	void wake_all(const std::optional<WeatherSnapshot>& result) {
+		// Detach the whole list first: resumed coroutines wait again on a
+		// fresh list and must not see this reading twice
+		MeasurementAwaiter* awaiter = m_head;
+		m_head = nullptr;
+		m_waiting_count = 0;
+		while (awaiter) {
+			MeasurementAwaiter* next = awaiter->m_next;
+			awaiter->m_linked = false;
+			awaiter->m_result = result;
+			m_executor.schedule(awaiter->m_handle);
+			awaiter = next;
+		}
+	}
+
+	// weak: the subject already owns this observer
+	std::weak_ptr<WeatherDataSubject> m_weather_data_subject_ptr;
+	RunQueueExecutor& m_executor;
+	MeasurementAwaiter* m_head = nullptr;
+	std::size_t m_waiting_count = 0;
+	bool m_closed = false;
+};
+
+
+// ---------- Awaiter (needs the feed) ----------
+inline bool MeasurementAwaiter::await_ready() const noexcept {
+	return m_feed.is_closed() || m_stop.stop_requested();
+}
+
+inline void MeasurementAwaiter::await_suspend(std::coroutine_handle<> handle) {
+	m_handle = handle;
+	m_feed.link(this);
+	if (m_stop.stop_possible()) {
+		m_stop_callback.emplace(m_stop, Cancel{ this });
+	}
+}
+
+inline void MeasurementAwaiter::Cancel::operator()() const noexcept {
+	// Already woken by a reading: nothing to cancel
+	if (!m_awaiter->m_linked) {
+		return;
+	}
+	m_awaiter->m_feed.unlink(m_awaiter);
+	m_awaiter->m_result.reset();
+	m_awaiter->m_feed.m_executor.schedule(m_awaiter->m_handle);
+}
+
+
+// ---------------- Example ----------------
+// Multi-step reactions written as plain loops instead of update() state machines
+
+// Counts one alert after three rising temperatures in a row, then finishes
+inline WeatherTask watch_for_rising_temperature(AwaitableWeatherFeed& feed, std::stop_token stop, std::size_t& alerts) {
+	std::optional<float> last;
+	int rising = 0;
+	while (auto measurement = co_await feed.next_measurement(stop)) {
+		rising = (last && measurement->m_temperature > *last) ? rising + 1 : 0;
+		last = measurement->m_temperature;
+		if (rising == 3) {
+			++alerts;
+			co_return;
+		}
+	}
+}
+
+// Averages the next 'count' pressures, then finishes
+inline WeatherTask average_pressure(AwaitableWeatherFeed& feed, std::stop_token stop, int count, double& total) {
+	double sum = 0.0;
+	for (int i = 0; i < count; ++i) {
+		auto measurement = co_await feed.next_measurement(stop);
+		if (!measurement) {
+			co_return;
+		}
+		sum += measurement->m_pressure;
+	}
+	total += sum / count;
+}
+
+inline void observer_7() {
+
+	CoroutineFramePool& pool = CoroutineFramePool::get_instance();
+	RunQueueExecutor executor;
+
+	std::shared_ptr<SimulatedWeatherData> sensor = std::make_shared<SimulatedWeatherData>();
+	std::shared_ptr<WeatherDataSubject> subject = std::make_shared<WeatherDataSubject>(sensor);
+
+	// A classic callback display and the coroutine feed share one subject
+	std::shared_ptr<CurrentConditionsDisplay> display = std::make_shared<CurrentConditionsDisplay>(subject);
+	display->register_self();
+	std::shared_ptr<AwaitableWeatherFeed> feed = std::make_shared<AwaitableWeatherFeed>(subject, executor);
+	feed->register_self();
+
+	// 100k consumers.  The averaging half can be cancelled as a group.
+	const std::size_t consumer_count = 100000;
+	std::stop_source cancel_averages;
+	std::size_t alerts = 0;
+	double average_total = 0.0;
+	const auto spawn_start = std::chrono::steady_clock::now();
+	for (std::size_t i = 0; i < consumer_count; ++i) {
+		if (i % 2 == 0) {
+			watch_for_rising_temperature(*feed, {}, alerts);
+		} else {
+			average_pressure(*feed, cancel_averages.get_token(), 1000, average_total);
+		}
+	}
+	const auto spawn_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - spawn_start);
+	print(std::to_string(pool.get_live_frames()) + " suspended consumers in " + std::to_string(spawn_time.count()) + " us, "
+		+ std::to_string(pool.get_reserved_bytes() / 1024) + " KB of frames");
+
+	// Four rising readings: every temperature watcher fires
+	const auto run_start = std::chrono::steady_clock::now();
+	for (int i = 0; i < 4; ++i) {
+		sensor->set_readings(70.0f + static_cast<float>(i), 40.0f, 1010.0f + static_cast<float>(i));
+		subject->set_measurements();
+		executor.run();
+	}
+	const auto run_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - run_start);
+	print("4 readings delivered in " + std::to_string(run_time.count()) + " us, alerts: " + std::to_string(alerts)
+		+ ", still waiting: " + std::to_string(feed->get_waiting_count()));
+	display->display();
+
+	// The averages will never reach 1000 readings; cancel them
+	cancel_averages.request_stop();
+	executor.run();
+	print("After cancelling the averages, live frames: " + std::to_string(pool.get_live_frames()));
+
+	feed->close();
+	executor.run();
+	subject->remove_observer(feed);
+	subject->remove_observer(display);
+}
@@ -0,0 +1,423 @@
+#pragma once
+#include "Print.hpp"
+#include "Trace.hpp"
+#include "Observer_1.hpp"
+#include "Observer_2.hpp"
+#include "Observer_3.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Concept From: Head First Design Patterns
+// Example in C++ written by: Paul Burgess
+
+// Alert Rule Engine (Columnar Observer)
+// Thousands of alert rules ("temperature above 95", "pressure falls by more
+// than 2 between readings") could each be their own observer, but then every
+// measurement makes thousands of virtual update() calls, each re-reading the
+// subject and testing a single rule.
+
+// Here one observer owns all the rules.  The rules are compiled into columns:
+// one column per (field, value or change, greater or less) with a packed array
+// of thresholds and a matching array of rule ids.  A measurement is then
+// checked with one tight loop per column.  The loop works on fixed blocks of
+// 16 thresholds with no branches, which the compiler turns into SIMD compares.
+// Only blocks with a hit are scanned for the ids that fired.
+
+// Rules can be added and removed from any thread while measurements keep
+// coming in.  An edit builds a whole new table off to the side, swaps the
+// pointer under a short lock, and bumps a version counter.  The ingesting
+// thread checks the counter on every measurement and only takes the lock (to
+// copy one pointer) after an edit.  It never waits while a table is built.
+
+
+// ---------- Rules ----------
+enum class WeatherField : std::uint8_t {
+	temperature,
+	humidity,
+	pressure
+};
+
+enum class AlertCondition : std::uint8_t {
+	above,     // value > threshold
+	below,     // value < threshold
+	rises_by,  // value - previous value > threshold
+	falls_by   // previous value - value > threshold
+};
+
+struct AlertRule {
+	std::uint32_t m_id;
+	WeatherField m_field;
+	AlertCondition m_condition;
+	float m_threshold;
+};
+
+inline float get_field(const WeatherSnapshot& snapshot, WeatherField field) {
+	switch (field) {
+	case WeatherField::temperature:
+		return snapshot.m_temperature;
+	case WeatherField::humidity:
+		return snapshot.m_humidity;
+	default:
+		return snapshot.m_pressure;
+	}
+}
+
+
+// ---------- Compiled Rule Table ----------
+// Immutable once built; the engine swaps whole tables
+class AlertRuleTable {
+
+public:
+	static constexpr std::size_t block_size = 16;
+
+	explicit AlertRuleTable(std::vector<AlertRule> rules)
+		:m_rules{ std::move(rules) } {
+		for (const AlertRule& rule : m_rules) {
+			const bool on_change = rule.m_condition == AlertCondition::rises_by || rule.m_condition == AlertCondition::falls_by;
+			const bool greater = rule.m_condition == AlertCondition::above || rule.m_condition == AlertCondition::rises_by;
+			// "falls by t" is "change < -t"
+			const float threshold = rule.m_condition == AlertCondition::falls_by ? -rule.m_threshold : rule.m_threshold;
+			Column& column = m_columns[column_index(rule.m_field, on_change, greater)];
+			column.m_thresholds.push_back(threshold);
+			column.m_rule_ids.push_back(rule.m_id);
+		}
+		// Pad to whole blocks with thresholds that can never fire (NaN inputs
+		// never fire either, since every comparison with NaN is false)
+		for (std::size_t i = 0; i < m_columns.size(); ++i) {
+			Column& column = m_columns[i];
+			const float never = (i % 2 == 1) ? std::numeric_limits<float>::infinity() : -std::numeric_limits<float>::infinity();
+			const std::size_t padded = (column.m_thresholds.size() + block_size - 1) / block_size * block_size;
+			column.m_thresholds.resize(padded, never);
+			column.m_rule_ids.resize(padded, 0);
+		}
+	}
+
+	// Appends the ids of every rule that fires.  'previous' is null for the
+	// first measurement (no change rules can fire yet).
+	void evaluate(const WeatherSnapshot& current, const WeatherSnapshot* previous, std::vector<std::uint32_t>& fired) const {
+		for (const WeatherField field : { WeatherField::temperature, WeatherField::humidity, WeatherField::pressure }) {
+			const float value = get_field(current, field);
+			scan<false>(m_columns[column_index(field, false, false)], value, fired);
+			scan<true>(m_columns[column_index(field, false, true)], value, fired);
+			if (previous) {
+				const float change = value - get_field(*previous, field);
+				scan<false>(m_columns[column_index(field, true, false)], change, fired);
+				scan<true>(m_columns[column_index(field, true, true)], change, fired);
+			}
+		}
+	}
+
+	const std::vector<AlertRule>& get_rules() const {
+		return m_rules;
+	}
+
+private:
+	struct Column {
+		std::vector<float> m_thresholds;
+		std::vector<std::uint32_t> m_rule_ids;
+	};
+
+	// Odd indices are "greater than" columns
+	static std::size_t column_index(WeatherField field, bool on_change, bool greater) {
+		return (static_cast<std::size_t>(field) * 2 + (on_change ? 1 : 0)) * 2 + (greater ? 1 : 0);
+	}
+
+	template <bool Greater>
+	static void scan(const Column& column, float input, std::vector<std::uint32_t>& fired) {
+		const float* thresholds = column.m_thresholds.data();
+		const std::size_t count = column.m_thresholds.size();
+		for (std::size_t block = 0; block < count; block += block_size) {
+			// Branch-free compare of a whole block (vectorized by the compiler)
+			unsigned char hits[block_size];
+			unsigned char any = 0;
+			for (std::size_t i = 0; i < block_size; ++i) {
+				hits[i] = Greater ? (input > thresholds[block + i]) : (input < thresholds[block + i]);
+				any |= hits[i];
+			}
+			if (any == 0) {
+				continue;
+			}
+			for (std::size_t i = 0; i < block_size; ++i) {
+				if (hits[i]) {
+					fired.push_back(column.m_rule_ids[block + i]);
+				}
+			}
+		}
+	}
+
+	std::vector<AlertRule> m_rules;
+	std::array<Column, 12> m_columns;
+};
+
+
+// ---------- Alert Handler ----------
+class IAlertHandler {
+public:
+	IAlertHandler() = default;
+	virtual ~IAlertHandler() = default;
+
+	// Only called when at least one rule fired
+	virtual void on_alerts(const std::vector<std::uint32_t>& rule_ids) = 0;
+};
+
+
+// --------------------- Observer (one for all rules) ---------------------
+class AlertRuleEngine : public IObserver, public std::enable_shared_from_this<AlertRuleEngine> {
+
+public:
+	AlertRuleEngine(const std::shared_ptr<WeatherDataSubject>& weather_data_subject_ptr, const std::shared_ptr<IAlertHandler>& alert_handler_ptr)
+		:m_weather_data_subject_ptr{ weather_data_subject_ptr },
+		m_alert_handler_ptr{ alert_handler_ptr },
+		m_table{ std::make_shared<const AlertRuleTable>(std::vector<AlertRule>{}) },
+		m_current_table{ m_table } {
+	}
+
+	void register_self() override {
+		if (auto subject = m_weather_data_subject_ptr.lock()) {
+			subject->register_observer(shared_from_this());
+		}
+	}
+
+	void update() override {
+		if (auto subject = m_weather_data_subject_ptr.lock()) {
+			evaluate(WeatherSnapshot{ subject->get_temperature(), subject->get_humidity(), subject->get_pressure() });
+		}
+	}
+
+	// Ingestion side (one thread).  Returns the ids of the rules that fired.
+	const std::vector<std::uint32_t>& evaluate(const WeatherSnapshot& snapshot) {
+		TRACE_SPAN("AlertRuleEngine::evaluate");
+		const std::uint64_t version = m_table_version.load(std::memory_order_acquire);
+		if (version != m_current_version) {
+			std::lock_guard<std::mutex> lock{ m_table_mutex };
+			m_current_table = m_table;
+			m_current_version = version;
+		}
+		m_fired.clear();
+		m_current_table->evaluate(snapshot, m_has_previous ? &m_previous : nullptr, m_fired);
+		m_previous = snapshot;
+		m_has_previous = true;
+		if (!m_fired.empty() && m_alert_handler_ptr) {
+			m_alert_handler_ptr->on_alerts(m_fired);
+		}
+		return m_fired;
+	}
+
+	// Edits (any thread).  A rule with an existing id replaces it.
+	void add_rule(const AlertRule& rule) {
+		add_rules({ rule });
+	}
+
+	void add_rules(const std::vector<AlertRule>& rules) {
+		TRACE_SPAN("AlertRuleEngine::add_rules");
+		std::lock_guard<std::mutex> lock{ m_edit_mutex };
+		std::vector<AlertRule> updated = m_table->get_rules();
+		for (const AlertRule& rule : rules) {
+			auto existing = std::find_if(updated.begin(), updated.end(), [&rule](const AlertRule& current) { return current.m_id == rule.m_id; });
+			if (existing != updated.end()) {
+				*existing = rule;
+			} else {
+				updated.push_back(rule);
+			}
+		}
+		publish(std::make_shared<const AlertRuleTable>(std::move(updated)));
+	}
+
+	// Returns false when no rule has that id
+	bool remove_rule(std::uint32_t id) {
+		TRACE_SPAN("AlertRuleEngine::remove_rule");
+		std::lock_guard<std::mutex> lock{ m_edit_mutex };
+		std::vector<AlertRule> updated = m_table->get_rules();
+		const auto removed = std::remove_if(updated.begin(), updated.end(), [id](const AlertRule& rule) { return rule.m_id == id; });
+		if (removed == updated.end()) {
+			return false;
+		}
+		updated.erase(removed, updated.end());
+		publish(std::make_shared<const AlertRuleTable>(std::move(updated)));
+		return true;
+	}
+
+	std::size_t get_rule_count() const {
+		std::lock_guard<std::mutex> lock{ m_table_mutex };
+		return m_table->get_rules().size();
+	}
+
+private:
+	// Called with m_edit_mutex held
+	void publish(std::shared_ptr<const AlertRuleTable> table) {
+		{
+			std::lock_guard<std::mutex> lock{ m_table_mutex };
+			m_table.swap(table);
+		}
+		m_table_version.fetch_add(1, std::memory_order_release);
+		// The old table is released here (or by the ingesting thread if it
+		// still holds it), outside the lock
+	}
+
+	// weak: the subject already owns this observer
+	std::weak_ptr<WeatherDataSubject> m_weather_data_subject_ptr;
+	std::shared_ptr<IAlertHandler> m_alert_handler_ptr;
+
+	// Edits are serialized by m_edit_mutex; m_table is only written with
+	// both mutexes held
+	std::mutex m_edit_mutex;
+	mutable std::mutex m_table_mutex;
+	std::shared_ptr<const AlertRuleTable> m_table;
+	std::atomic<std::uint64_t> m_table_version{ 0 };
+
+	// Ingestion-side state
+	std::shared_ptr<const AlertRuleTable> m_current_table;
+	std::uint64_t m_current_version = 0;
+	WeatherSnapshot m_previous{};
+	bool m_has_previous = false;
+	std::vector<std::uint32_t> m_fired;
+};
+
+
+// ---------------- One Observer Per Rule (for comparison) ----------------
+class ThresholdRuleObserver : public IObserver, public std::enable_shared_from_this<ThresholdRuleObserver> {
+
+public:
+	ThresholdRuleObserver(const std::shared_ptr<WeatherDataSubject>& weather_data_subject_ptr, const AlertRule& rule, std::vector<std::uint32_t>& fired)
+		:m_weather_data_subject_ptr{ weather_data_subject_ptr },
+		m_rule{ rule },
+		m_fired{ fired } {
+	}
+
+	void register_self() override {
+		if (auto subject = m_weather_data_subject_ptr.lock()) {
+			subject->register_observer(shared_from_this());
+		}
+	}
+
+	void update() override {
+		auto subject = m_weather_data_subject_ptr.lock();
+		const float value = get_field(WeatherSnapshot{ subject->get_temperature(), subject->get_humidity(), subject->get_pressure() }, m_rule.m_field);
+		bool fires = false;
+		switch (m_rule.m_condition) {
+		case AlertCondition::above:
+			fires = value > m_rule.m_threshold;
+			break;
+		case AlertCondition::below:
+			fires = value < m_rule.m_threshold;
+			break;
+		case AlertCondition::rises_by:
+			fires = m_has_previous && value - m_previous > m_rule.m_threshold;
+			break;
+		case AlertCondition::falls_by:
+			fires = m_has_previous && m_previous - value > m_rule.m_threshold;
+			break;
+		}
+		m_previous = value;
+		m_has_previous = true;
+		if (fires) {
+			m_fired.push_back(m_rule.m_id);
+		}
+	}
+
+private:
+	std::weak_ptr<WeatherDataSubject> m_weather_data_subject_ptr;
+	AlertRule m_rule;
+	std::vector<std::uint32_t>& m_fired;
+	float m_previous = 0.0f;
+	bool m_has_previous = false;
+};
+
+
+// ---------------- Example ----------------
+class CountingAlertHandler : public IAlertHandler {
+public:
+	void on_alerts(const std::vector<std::uint32_t>& rule_ids) override {
+		m_alerts.fetch_add(rule_ids.size(), std::memory_order_relaxed);
+	}
+	std::size_t get_alert_count() const {
+		return m_alerts.load(std::memory_order_relaxed);
+	}
+private:
+	std::atomic<std::size_t> m_alerts{ 0 };
+};
+
+// A spread of thresholds over all fields and conditions
+inline std::vector<AlertRule> make_alert_rules(std::size_t count, std::uint32_t first_id = 0) {
+	std::vector<AlertRule> rules;
+	rules.reserve(count);
+	for (std::size_t i = 0; i < count; ++i) {
+		const auto field = static_cast<WeatherField>(i % 3);
+		const auto condition = static_cast<AlertCondition>((i / 3) % 4);
+		const float base = field == WeatherField::pressure ? 1000.0f : 50.0f;
+		const float spread = static_cast<float>(i % 97);
+		const bool on_change = condition == AlertCondition::rises_by || condition == AlertCondition::falls_by;
+		rules.push_back(AlertRule{ first_id + static_cast<std::uint32_t>(i), field, condition, on_change ? 1.0f + spread / 10.0f : base + spread });
+	}
+	return rules;
+}
+
+inline void observer_8() {
+
+	const std::size_t rule_count = 4096;
+	const std::size_t measurement_count = 2000;
+
+	std::shared_ptr<SimulatedWeatherData> sensor = std::make_shared<SimulatedWeatherData>();
+	std::shared_ptr<WeatherDataSubject> subject = std::make_shared<WeatherDataSubject>(sensor);
+	const std::vector<AlertRule> rules = make_alert_rules(rule_count);
+
+	const auto feed_measurements = [&]() {
+		const auto start = std::chrono::steady_clock::now();
+		for (std::size_t i = 0; i < measurement_count; ++i) {
+			const float wave = static_cast<float>(i % 40);
+			sensor->set_readings(60.0f + wave, 50.0f + wave / 2.0f, 1040.0f - wave);
+			subject->set_measurements();
+		}
+		return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / measurement_count;
+	};
+
+	// One observer per rule
+	std::vector<std::uint32_t> per_rule_fired;
+	std::vector<std::shared_ptr<ThresholdRuleObserver>> rule_observers;
+	for (const AlertRule& rule : rules) {
+		rule_observers.push_back(std::make_shared<ThresholdRuleObserver>(subject, rule, per_rule_fired));
+		rule_observers.back()->register_self();
+	}
+	const double per_rule_us = feed_measurements();
+	for (const auto& observer : rule_observers) {
+		subject->remove_observer(observer);
+	}
+
+	// One engine for all rules
+	std::shared_ptr<CountingAlertHandler> handler = std::make_shared<CountingAlertHandler>();
+	std::shared_ptr<AlertRuleEngine> engine = std::make_shared<AlertRuleEngine>(subject, handler);
+	engine->add_rules(rules);
+	engine->register_self();
+	const double engine_us = feed_measurements();
+
+	print(std::to_string(rule_count) + " rules, " + std::to_string(measurement_count) + " measurements");
+	print("  One observer per rule: " + std::to_string(per_rule_us) + " us per measurement, " + std::to_string(per_rule_fired.size()) + " alerts");
+	print("  Columnar rule engine:  " + std::to_string(engine_us) + " us per measurement, " + std::to_string(handler->get_alert_count()) + " alerts");
+
+	// Rules change on another thread while measurements keep coming in
+	std::atomic<bool> editing{ true };
+	std::thread editor([&]() {
+		std::uint32_t next_id = static_cast<std::uint32_t>(rule_count);
+		while (editing.load(std::memory_order_relaxed)) {
+			engine->add_rule(AlertRule{ next_id, WeatherField::temperature, AlertCondition::above, 65.0f });
+			engine->remove_rule(next_id - static_cast<std::uint32_t>(rule_count));
+			++next_id;
+		}
+	});
+	const double editing_us = feed_measurements();
+	editing.store(false, std::memory_order_relaxed);
+	editor.join();
+	print("  While editing rules:   " + std::to_string(editing_us) + " us per measurement, " + std::to_string(engine->get_rule_count()) + " rules now");
+
+	subject->remove_observer(engine);
+}
@@ -0,0 +1,288 @@
+#pragma once
+#include "Print.hpp"
+#include "Trace.hpp"
+#include "LatencyHistogram.hpp"
+#include "Observer_1.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Concept From: Head First Design Patterns
+// Example in C++ written by: Paul Burgess
+
+// Load Testing the Observer
+// WeatherDataFromDB (Observer_1.hpp) always returns the same three numbers.
+// SyntheticWeatherData is a getter that produces realistic readings instead:
+// each field follows its own distribution (constant, uniform, normal or a
+// random walk).  An ArrivalSchedule decides when each reading arrives: a
+// target rate, evenly spaced or random (Poisson), optionally with periodic
+// bursts.  Both are driven by a seeded generator written out here, so the
+// same seed gives the same readings and arrival times on every compiler and
+// platform (the std:: distributions are not portable).
+
+// replay_weather_load() drives a WeatherDataSubject from a schedule and
+// measures each set_measurements() call.  Latency is taken from the
+// *scheduled* arrival time, not from when the call started.  If the
+// observers are too slow and calls start late, the waiting counts as
+// latency too (avoiding "coordinated omission", where a slow system looks
+// fast because it was sent less work).  The results are HDR histograms (see
+// LatencyHistogram.hpp).
+
+
+// ---------- Deterministic Random Numbers ----------
+// SplitMix64: tiny, fast, and the same sequence everywhere
+class SplitMix64 {
+
+public:
+	explicit SplitMix64(std::uint64_t seed)
+		:m_state{ seed } {
+	}
+
+	std::uint64_t next() {
+		std::uint64_t z = (m_state += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	// Uniform in [0, 1)
+	double next_unit() {
+		return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+	}
+
+	// Standard normal (Box-Muller)
+	double next_normal() {
+		const double u1 = 1.0 - next_unit(); // (0, 1]: log() is finite
+		const double u2 = next_unit();
+		return std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+	}
+
+	// Exponential with the given mean
+	double next_exponential(double mean) {
+		return -mean * std::log(1.0 - next_unit());
+	}
+
+private:
+	std::uint64_t m_state;
+};
+
+
+// ---------- Synthetic Readings ----------
+enum class ReadingDistribution {
+	constant,     // always 'center'
+	uniform,      // center +/- spread
+	normal,       // mean 'center', standard deviation 'spread'
+	random_walk   // starts at 'center', each step adds normal(0, spread)
+};
+
+struct FieldModel {
+	ReadingDistribution m_distribution = ReadingDistribution::constant;
+	float m_center = 0.0f;
+	float m_spread = 0.0f;
+};
+
+class SyntheticWeatherData : public IWeatherDataGetter {
+
+public:
+	SyntheticWeatherData(std::uint64_t seed, const FieldModel& temperature, const FieldModel& humidity, const FieldModel& pressure)
+		:m_random{ seed },
+		m_temperature_model{ temperature },
+		m_humidity_model{ humidity },
+		m_pressure_model{ pressure },
+		m_temperature{ temperature.m_center },
+		m_humidity{ humidity.m_center },
+		m_pressure{ pressure.m_center } {
+	}
+
+	// Moves to the next reading
+	void advance() {
+		m_temperature = next_value(m_temperature_model, m_temperature);
+		m_humidity = next_value(m_humidity_model, m_humidity);
+		m_pressure = next_value(m_pressure_model, m_pressure);
+	}
+
+	float get_temperature() const override {
+		return m_temperature;
+	}
+
+	float get_humidity() const override {
+		return m_humidity;
+	}
+
+	float get_pressure() const override {
+		return m_pressure;
+	}
+
+private:
+	float next_value(const FieldModel& model, float previous) {
+		switch (model.m_distribution) {
+		case ReadingDistribution::uniform:
+			return model.m_center + model.m_spread * static_cast<float>(2.0 * m_random.next_unit() - 1.0);
+		case ReadingDistribution::normal:
+			return model.m_center + model.m_spread * static_cast<float>(m_random.next_normal());
+		case ReadingDistribution::random_walk:
+			return previous + model.m_spread * static_cast<float>(m_random.next_normal());
+		default:
+			return model.m_center;
+		}
+	}
+
+	SplitMix64 m_random;
+	FieldModel m_temperature_model;
+	FieldModel m_humidity_model;
+	FieldModel m_pressure_model;
+	float m_temperature;
+	float m_humidity;
+	float m_pressure;
+};
+
+
+// ---------- Arrival Schedule ----------
+struct LoadProfile {
+	double m_rate_per_second = 10000.0;
+	bool m_poisson_arrivals = false;            // random gaps instead of even spacing
+
+	// Every burst period starts with a burst: for 'burst length' the rate is
+	// multiplied by 'burst multiplier'
+	double m_burst_multiplier = 1.0;
+	std::chrono::nanoseconds m_burst_period{ 0 };
+	std::chrono::nanoseconds m_burst_length{ 0 };
+};
+
+class ArrivalSchedule {
+
+public:
+	ArrivalSchedule(std::uint64_t seed, const LoadProfile& profile)
+		:m_random{ seed },
+		m_profile{ profile } {
+	}
+
+	// Time of the next arrival, measured from the start of the run
+	std::chrono::nanoseconds next_arrival() {
+		const std::chrono::nanoseconds current = m_next;
+		double rate = m_profile.m_rate_per_second;
+		if (m_profile.m_burst_period.count() > 0 && current % m_profile.m_burst_period < m_profile.m_burst_length) {
+			rate *= m_profile.m_burst_multiplier;
+		}
+		const double mean_gap_ns = 1e9 / rate;
+		const double gap_ns = m_profile.m_poisson_arrivals ? m_random.next_exponential(mean_gap_ns) : mean_gap_ns;
+		m_remainder_ns += gap_ns;
+		const auto whole_ns = static_cast<std::int64_t>(m_remainder_ns);
+		m_remainder_ns -= static_cast<double>(whole_ns);
+		m_next += std::chrono::nanoseconds{ whole_ns };
+		return current;
+	}
+
+private:
+	SplitMix64 m_random;
+	LoadProfile m_profile;
+	std::chrono::nanoseconds m_next{ 0 };
+	double m_remainder_ns = 0.0; // keeps fractional gaps from drifting the rate
+};
+
+
+// ---------- Replay Harness ----------
+struct ReplayResult {
+	std::size_t m_measurements = 0;
+	double m_target_rate = 0.0;
+	double m_achieved_rate = 0.0;
+	LatencyHistogram m_latency;      // scheduled arrival -> set_measurements() returned
+	LatencyHistogram m_service_time; // set_measurements() start -> return
+};
+
+inline ReplayResult replay_weather_load(WeatherDataSubject& subject, SyntheticWeatherData& readings, ArrivalSchedule& schedule, double target_rate, std::size_t measurement_count) {
+	using Clock = std::chrono::steady_clock;
+
+	ReplayResult result;
+	result.m_measurements = measurement_count;
+	result.m_target_rate = target_rate;
+
+	const Clock::time_point start = Clock::now();
+	for (std::size_t i = 0; i < measurement_count; ++i) {
+		const Clock::time_point scheduled = start + schedule.next_arrival();
+
+		// Sleep while the arrival is far off, then spin for precision
+		Clock::time_point now = Clock::now();
+		while (now < scheduled) {
+			if (scheduled - now > std::chrono::microseconds{ 200 }) {
+				std::this_thread::sleep_for(scheduled - now - std::chrono::microseconds{ 100 });
+			} else {
+				std::this_thread::yield();
+			}
+			now = Clock::now();
+		}
+
+		readings.advance();
+		const Clock::time_point call_start = Clock::now();
+		subject.set_measurements();
+		const Clock::time_point call_end = Clock::now();
+
+		result.m_latency.record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(call_end - scheduled).count()));
+		result.m_service_time.record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(call_end - call_start).count()));
+	}
+	const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	result.m_achieved_rate = static_cast<double>(measurement_count) / seconds;
+	return result;
+}
+
+
+// ---------------- Example ----------------
+inline void observer_9() {
+
+	const std::uint64_t seed = 2024;
+	const FieldModel temperature{ ReadingDistribution::random_walk, 70.0f, 0.2f };
+	const FieldModel humidity{ ReadingDistribution::normal, 45.0f, 5.0f };
+	const FieldModel pressure{ ReadingDistribution::uniform, 1013.0f, 8.0f };
+
+	// Same seed, same readings
+	SyntheticWeatherData first{ seed, temperature, humidity, pressure };
+	SyntheticWeatherData second{ seed, temperature, humidity, pressure };
+	bool identical = true;
+	for (int i = 0; i < 1000; ++i) {
+		first.advance();
+		second.advance();
+		identical = identical && first.get_temperature() == second.get_temperature() && first.get_pressure() == second.get_pressure();
+	}
+	print(std::string{ "Two generators with seed " } + std::to_string(seed) + (identical ? " produced identical readings" : " DIFFERED"));
+
+	// Poisson arrivals at 20k/s, with a 5x burst for 10 ms out of every 100 ms
+	LoadProfile profile;
+	profile.m_rate_per_second = 20000.0;
+	profile.m_poisson_arrivals = true;
+	profile.m_burst_multiplier = 5.0;
+	profile.m_burst_period = std::chrono::milliseconds{ 100 };
+	profile.m_burst_length = std::chrono::milliseconds{ 10 };
+
+	for (const std::size_t display_count : { 8, 64, 512 }) {
+		std::shared_ptr<SyntheticWeatherData> readings = std::make_shared<SyntheticWeatherData>(seed, temperature, humidity, pressure);
+		std::shared_ptr<WeatherDataSubject> subject = std::make_shared<WeatherDataSubject>(readings);
+		std::vector<std::shared_ptr<CurrentConditionsDisplay>> displays;
+		for (std::size_t i = 0; i < display_count; ++i) {
+			displays.push_back(std::make_shared<CurrentConditionsDisplay>(subject));
+			displays.back()->register_self();
+		}
+
+		ArrivalSchedule schedule{ seed, profile };
+		const ReplayResult result = replay_weather_load(*subject, *readings, schedule, profile.m_rate_per_second, 6000);
+		print(std::to_string(display_count) + " displays: achieved " + std::to_string(static_cast<long long>(result.m_achieved_rate))
+			+ "/s, latency p50 " + std::to_string(result.m_latency.value_at_percentile(50.0))
+			+ " ns, p99 " + std::to_string(result.m_latency.value_at_percentile(99.0))
+			+ " ns, p99.9 " + std::to_string(result.m_latency.value_at_percentile(99.9))
+			+ " ns, service p50 " + std::to_string(result.m_service_time.value_at_percentile(50.0)) + " ns");
+
+		if (display_count == 512 && print_enabled()) {
+			print("Latency distribution (us):");
+			result.m_latency.write_percentile_distribution(std::cout, 1000.0);
+		}
+
+		for (const auto& display : displays) {
+			subject->remove_observer(display);
+		}
+	}
+}
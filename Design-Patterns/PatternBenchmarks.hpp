@@ -0,0 +1,656 @@
+#pragma once
+#include "BenchmarkHarness.hpp"
+#include "Print.hpp"
+#include "Strategy_1.hpp"
+#include "Strategy_3.hpp"
+#include "Strategy_4.hpp"
+#include "Observer_1.hpp"
+#include "Observer_2.hpp"
+#include "Observer_3.hpp"
+#include "Observer_7.hpp"
+#include "Observer_8.hpp"
+#include "Decorator_1.hpp"
+#include "Factory_1.hpp"
+#include "Factory_2.hpp"
+#include "Singleton_1.hpp"
+#include "Singleton_2.hpp"
+#include "Command.hpp"
+#include "Command_4.hpp"
+#include "Adapter.hpp"
+#include "Adapter_2.hpp"
+#include "Adapter_3.hpp"
+#include "PrincipleOfLeastKnowledge.hpp"
+#include "PrincipleOfLeastKnowledge_2.hpp"
+#include "PrincipleOfLeastKnowledge_3.hpp"
+#include "TemplateMethod_1.hpp"
+#include "TemplateMethod_3.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Example in C++ written by: Paul Burgess
+
+// Pattern Benchmarks
+// The hot path of each pattern, measured with BenchmarkHarness.hpp.  Names
+// are "<pattern>/<case>[/<size>]" so a filter like "observer/" selects one
+// pattern.  Where a case does several units of work per iteration (observers
+// notified, decorator layers, records converted), that count is reported as
+// items per iteration and the JSON carries the cost per item too.
+
+// Strategy_2.hpp writes to std::cout directly (not through print()), so its
+// output cannot be switched off; the strategy cases use Strategy_1.hpp.
+
+
+// ---------- Observer ----------
+// One subject with 'count' observers; notify cost scales with the count
+struct RawObserverFixture {
+	explicit RawObserverFixture(std::size_t count)
+		:m_subject{ &m_getter } {
+		for (std::size_t i = 0; i < count; ++i) {
+			m_observers.push_back(std::make_unique<CurrentConditionsDisplayRaw>(&m_subject));
+		}
+	}
+
+	WeatherDataFromDBRaw m_getter;
+	WeatherDataSubjectRaw m_subject;
+	std::vector<std::unique_ptr<CurrentConditionsDisplayRaw>> m_observers;
+};
+
+struct SharedObserverFixture {
+	explicit SharedObserverFixture(std::size_t count)
+		:m_subject{ std::make_shared<WeatherDataSubject>(std::make_shared<WeatherDataFromDB>()) } {
+		for (std::size_t i = 0; i < count; ++i) {
+			m_observers.push_back(std::make_shared<CurrentConditionsDisplay>(m_subject));
+			m_observers.back()->register_self();
+		}
+	}
+
+	// The subject and its observers point at each other; break the cycle
+	~SharedObserverFixture() {
+		for (const auto& observer : m_observers) {
+			m_subject->remove_observer(observer);
+		}
+	}
+
+	std::shared_ptr<WeatherDataSubject> m_subject;
+	std::vector<std::shared_ptr<CurrentConditionsDisplay>> m_observers;
+};
+
+// Same subject, but the 'count' observers are coroutines behind one
+// AwaitableWeatherFeed (Observer_7.hpp)
+inline WeatherTask count_measurements(AwaitableWeatherFeed& feed, std::size_t& received) {
+	// Keep the declaration: GCC 12 resumes a null handle when a bare
+	// co_await is the whole while condition
+	while (auto measurement = co_await feed.next_measurement()) {
+		++received;
+	}
+}
+
+struct CoroutineObserverFixture {
+	explicit CoroutineObserverFixture(std::size_t count)
+		:m_subject{ std::make_shared<WeatherDataSubject>(std::make_shared<WeatherDataFromDB>()) },
+		m_feed{ std::make_shared<AwaitableWeatherFeed>(m_subject, m_executor) } {
+		m_feed->register_self();
+		for (std::size_t i = 0; i < count; ++i) {
+			count_measurements(*m_feed, m_received);
+		}
+	}
+
+	// Let the coroutines finish so their frames go back to the pool
+	~CoroutineObserverFixture() {
+		m_feed->close();
+		m_executor.run();
+		m_subject->remove_observer(m_feed);
+	}
+
+	RunQueueExecutor m_executor;
+	std::size_t m_received = 0;
+	std::shared_ptr<WeatherDataSubject> m_subject;
+	std::shared_ptr<AwaitableWeatherFeed> m_feed;
+};
+
+inline void register_observer_benchmarks(BenchmarkSuite& suite) {
+	for (const std::size_t count : { 1, 8, 64, 512 }) {
+		suite.add("observer/notify_raw/" + std::to_string(count), [count]() {
+			auto fixture = std::make_shared<RawObserverFixture>(count);
+			return [fixture](std::size_t iterations) {
+				for (std::size_t i = 0; i < iterations; ++i) {
+					fixture->m_subject.notify_observers();
+				}
+				do_not_optimize(fixture->m_observers.front());
+			};
+		}, count);
+
+		suite.add("observer/notify_shared/" + std::to_string(count), [count]() {
+			auto fixture = std::make_shared<SharedObserverFixture>(count);
+			return [fixture](std::size_t iterations) {
+				for (std::size_t i = 0; i < iterations; ++i) {
+					fixture->m_subject->notify_all_observers();
+				}
+				do_not_optimize(fixture->m_observers.front());
+			};
+		}, count);
+
+		// Notify plus resuming every waiting coroutine on the executor
+		suite.add("observer/notify_coroutine/" + std::to_string(count), [count]() {
+			auto fixture = std::make_shared<CoroutineObserverFixture>(count);
+			return [fixture](std::size_t iterations) {
+				for (std::size_t i = 0; i < iterations; ++i) {
+					fixture->m_subject->notify_all_observers();
+					fixture->m_executor.run();
+				}
+				do_not_optimize(fixture->m_received);
+			};
+		}, count);
+	}
+
+	// Uncontended read of all three measurements (see Observer_4.hpp for the
+	// multi-threaded stress test)
+	suite.add("observer/get_snapshot", []() {
+		auto fixture = std::make_shared<RawObserverFixture>(0);
+		return [fixture](std::size_t iterations) {
+			for (std::size_t i = 0; i < iterations; ++i) {
+				const WeatherSnapshot snapshot = fixture->m_subject.get_snapshot();
+				do_not_optimize(snapshot);
+			}
+		};
+	});
+
+	// Taking in one reading with 512 displays attached: eager update() on
+	// every display vs lazy displays that pull only when shown.  The versioned
+	// readings alternate so every call really changes a field.
+	const std::size_t display_count = 512;
+	suite.add("observer/ingest_eager/" + std::to_string(display_count), [display_count]() {
+		auto fixture = std::make_shared<SharedObserverFixture>(display_count);
+		return [fixture](std::size_t iterations) {
+			for (std::size_t i = 0; i < iterations; ++i) {
+				fixture->m_subject->set_measurements();
+			}
+			do_not_optimize(fixture->m_observers.front());
+		};
+	});
+
+	suite.add("observer/ingest_versioned/" + std::to_string(display_count), [display_count]() {
+		auto sensor = std::make_shared<SimulatedWeatherData>();
+		auto subject = std::make_shared<VersionedWeatherDataSubject>(sensor);
+		auto displays = std::make_shared<std::vector<LazyCurrentConditionsDisplay>>();
+		for (std::size_t i = 0; i < display_count; ++i) {
+			displays->emplace_back(subject);
+		}
+		return [sensor, subject, displays](std::size_t iterations) {
+			for (std::size_t i = 0; i < iterations; ++i) {
+				sensor->set_readings(91.5f, 37.45f, (i & 1) ? 88.0f : 89.0f);
+				const bool changed = subject->set_measurements();
+				do_not_optimize(changed);
+			}
+		};
+	});
+	// 4096 alert rules checked per measurement: one observer per rule versus
+	// the columnar engine (Observer_8.hpp).  Readings alternate so the change
+	// rules see movement.
+	const std::size_t rule_count = 4096;
+	suite.add("observer/alert_rules_per_observer/" + std::to_string(rule_count), [rule_count]() {
+		auto sensor = std::make_shared<SimulatedWeatherData>();
+		auto subject = std::make_shared<WeatherDataSubject>(sensor);
+		auto fired = std::make_shared<std::vector<std::uint32_t>>();
+		for (const AlertRule& rule : make_alert_rules(rule_count)) {
+			auto observer = std::make_shared<ThresholdRuleObserver>(subject, rule, *fired);
+			observer->register_self();
+		}
+		return [sensor, subject, fired](std::size_t iterations) {
+			for (std::size_t i = 0; i < iterations; ++i) {
+				sensor->set_readings((i & 1) ? 60.0f : 75.0f, 55.0f, (i & 1) ? 1040.0f : 1036.0f);
+				fired->clear();
+				subject->set_measurements();
+			}
+			do_not_optimize(fired->size());
+		};
+	}, rule_count);
+
+	suite.add("observer/alert_rules_columnar/" + std::to_string(rule_count), [rule_count]() {
+		auto sensor = std::make_shared<SimulatedWeatherData>();
+		auto subject = std::make_shared<WeatherDataSubject>(sensor);
+		auto engine = std::make_shared<AlertRuleEngine>(subject, nullptr);
+		engine->add_rules(make_alert_rules(rule_count));
+		engine->register_self();
+		return [sensor, subject, engine](std::size_t iterations) {
+			for (std::size_t i = 0; i < iterations; ++i) {
+				sensor->set_readings((i & 1) ? 60.0f : 75.0f, 55.0f, (i & 1) ? 1040.0f : 1036.0f);
+				subject->set_measurements();
+			}
+			do_not_optimize(engine);
+		};
+	}, rule_count);
+}
+
+
+// ---------- Strategy ----------
+struct BatchWeaponFixture {
+	explicit BatchWeaponFixture(std::size_t target_count)
+		:m_targets{ make_targets(target_count) },
+		m_damage(target_count) {
+		m_knight.set_weapon(std::make_unique<SwordBehavior>());
+	}
+
+	Knight m_knight;
+	std::vector<Target> m_targets;
+	std::vector<float> m_damage;
+};
+
+inline void register_strategy_benchmarks(BenchmarkSuite& suite) {
+
+	// Four characters holding four different weapons, so the call site sees
+	// every implementation
+	suite.add("strategy/dispatch", []() {
+		auto characters = std::make_shared<std::vector<std::unique_ptr<Character>>>();
+		characters->push_back(std::make_unique<Queen>());
+		characters->push_back(std::make_unique<King>());
+		characters->push_back(std::make_unique<Troll>());
+		characters->push_back(std::make_unique<Knight>());
+		(*characters)[0]->set_weapon(std::make_unique<SwordBehavior>());
+		(*characters)[1]->set_weapon(std::make_unique<AxeBehavior>());
+		(*characters)[2]->set_weapon(std::make_unique<KnifeBehavior>());
+		(*characters)[3]->set_weapon(std::make_unique<BowAndArrowBehavior>());
+		return [characters](std::size_t iterations) {
+			for (std::size_t i = 0; i < iterations; ++i) {
+				for (const auto& character : *characters) {
+					character->use_weapon();
+				}
+			}
+		};
+	}, 4);
+
+	// Swapping the strategy allocates a new behavior and frees the old one
+	suite.add("strategy/set_weapon", []() {
+		auto queen = std::make_shared<Queen>();
+		return [queen](std::size_t iterations) {
+			for (std::size_t i = 0; i < iterations; ++i) {
+				queen->set_weapon(std::make_unique<SwordBehavior>());
+			}
+			do_not_optimize(*queen);
+		};
+	});
+	// Flyweight versions (Strategy_3.hpp): handles into one shared pool
+	suite.add("strategy/flyweight_dispatch", []() {
+		auto weapons = std::make_shared<WeaponPool>();
+		auto characters = std::make_shared<std::vector<FlyweightCharacter>>();
+		characters->emplace_back(CharacterKind::queen, weapons->get_shared<SwordBehavior>());
+		characters->emplace_back(CharacterKind::king, weapons->get_shared<AxeBehavior>());
+		characters->emplace_back(CharacterKind::troll, weapons->get_shared<KnifeBehavior>());
+		characters->emplace_back(CharacterKind::knight, weapons->get_shared<BowAndArrowBehavior>());
+		return [weapons, characters](std::size_t iterations) {
+			for (std::size_t i = 0; i < iterations; ++i) {
+				for (const auto& character : *characters) {
+					character.use_weapon(*weapons);
+				}
+			}
+		};
+	}, 4);
+
+	suite.add("strategy/flyweight_set_weapon", []() {
+		auto weapons = std::make_shared<WeaponPool>();
+		auto queen = std::make_shared<FlyweightCharacter>(CharacterKind::queen, weapons->get_shared<NoWeapon>());
+		const WeaponPool::Handle sword = weapons->get_shared<SwordBehavior>();
+		return [weapons, queen, sword](std::size_t iterations) {
+			for (std::size_t i = 0; i < iterations; ++i) {
+				queen->set_weapon(sword);
+				clobber_memory();
+			}
+			do_not_optimize(*queen);
+		};
+	});
+
+	// Batch damage (Strategy_4.hpp): one virtual call per 4096 targets with
+	// the active kernel, the same forced to scalar, and one call per target
+	const std::size_t target_count = 4096;
+	suite.add("strategy/batch/" + std::to_string(target_count), [target_count]() {
+		auto state = std::make_shared<BatchWeaponFixture>(target_count);
+		return [state](std::size_t iterations) {
+			for (std::size_t i = 0; i < iterations; ++i) {
+				state->m_knight.use_weapon(state->m_targets, state->m_damage);
+				clobber_memory();
+			}
+		};
+	}, target_count);
+
+	suite.add("strategy/batch_scalar/" + std::to_string(target_count), [target_count]() {
+		auto state = std::make_shared<BatchWeaponFixture>(target_count);
+		return [state](std::size_t iterations) {
+			const WeaponKernel best_kernel = active_weapon_kernel();
+			active_weapon_kernel() = WeaponKernel::scalar;
+			for (std::size_t i = 0; i < iterations; ++i) {
+				state->m_knight.use_weapon(state->m_targets, state->m_damage);
+				clobber_memory();
+			}
+			active_weapon_kernel() = best_kernel;
+		};
+	}, target_count);
+
+	suite.add("strategy/per_target/" + std::to_string(target_count), [target_count]() {
+		auto state = std::make_shared<BatchWeaponFixture>(target_count);
+		return [state](std::size_t iterations) {
+			for (std::size_t i = 0; i < iterations; ++i) {
+				use_weapon_per_target(state->m_knight, state->m_targets, state->m_damage);
+				clobber_memory();
+			}
+		};
+	}, target_count);
+}
+
+
+// ---------- Decorator ----------
+// HouseBlend wrapped 'depth' times.  Every layer is one virtual call plus an
+// add (get_cost) or a string concatenation (get_description).
+struct DecoratorChain {
+	explicit DecoratorChain(std::size_t depth) {
+		m_layers.push_back(std::make_unique<HouseBlend>());
+		for (std::size_t i = 0; i < depth; ++i) {
+			IConsumable* inner = m_layers.back().get();
+			switch (i % 3) {
+			case 0: m_layers.push_back(std::make_unique<SprinklesDecorator>(inner)); break;
+			case 1: m_layers.push_back(std::make_unique<WhippedCreamDecorator>(inner)); break;
+			default: m_layers.push_back(std::make_unique<CherryDecorator>(inner)); break;
+			}
+		}
+	}
+
+	const IConsumable* get_outer() const {
+		return m_layers.back().get();
+	}
+
+	std::vector<std::unique_ptr<IConsumable>> m_layers;
+};
+
+inline void register_decorator_benchmarks(BenchmarkSuite& suite) {
+	for (const std::size_t depth : { 1, 4, 16, 64 }) {
+		suite.add("decorator/get_cost/" + std::to_string(depth), [depth]() {
+			auto chain = std::make_shared<DecoratorChain>(depth);
+			return [chain](std::size_t iterations) {
+				for (std::size_t i = 0; i < iterations; ++i) {
+					const float cost = chain->get_outer()->get_cost();
+					do_not_optimize(cost);
+				}
+			};
+		}, depth);
+	}
+
+	for (const std::size_t depth : { 1, 4, 16 }) {
+		suite.add("decorator/get_description/" + std::to_string(depth), [depth]() {
+			auto chain = std::make_shared<DecoratorChain>(depth);
+			return [chain](std::size_t iterations) {
+				for (std::size_t i = 0; i < iterations; ++i) {
+					const std::string description = chain->get_outer()->get_description();
+					do_not_optimize(description);
+				}
+			};
+		}, depth);
+	}
+}
+
+
+// ---------- Factory ----------
+// Creation through the factory interface, including the delete, since every
+// product the examples create is owned by the caller
+inline void register_factory_benchmarks(BenchmarkSuite& suite) {
+
+	suite.add("factory/abstract_create", []() {
+		std::shared_ptr<const FurnitureFactory> factory = std::make_shared<VictorianFurnitureFactory>();
+		return [factory](std::size_t iterations) {
+			for (std::size_t i = 0; i < iterations; ++i) {
+				const Chair* chair = factory->create_chair();
+				const CoffeeTable* coffee_table = factory->create_coffee_table();
+				do_not_optimize(chair);
+				do_not_optimize(coffee_table);
+				delete chair;
+				delete coffee_table;
+			}
+		};
+	});
+
+	suite.add("factory/method_create", []() {
+		std::shared_ptr<TransportCreator> creator = std::make_shared<TruckCreator>();
+		return [creator](std::size_t iterations) {
+			for (std::size_t i = 0; i < iterations; ++i) {
+				const Transport* transport = creator->create_and_test_transportation();
+				do_not_optimize(transport);
+				delete transport;
+			}
+		};
+	});
+}
+
+
+// ---------- Singleton ----------
+inline void register_singleton_benchmarks(BenchmarkSuite& suite) {
+
+	// The name is only used by the first call, but is built once up front so
+	// the loop does not time a string construction
+	suite.add("singleton/get_instance", []() {
+		auto name = std::make_shared<const std::string>("Comet");
+		return [name](std::size_t iterations) {
+			for (std::size_t i = 0; i < iterations; ++i) {
+				Singleton* singleton = Singleton::get_instance(*name);
+				do_not_optimize(singleton);
+			}
+		};
+	});
+
+	suite.add("singleton/thread_local_increment", []() {
+		return [](std::size_t iterations) {
+			for (std::size_t i = 0; i < iterations; ++i) {
+				ThreadLocalSingleton<RequestCounter>::get_instance()->increment();
+			}
+		};
+	});
+
+	suite.add("singleton/per_node_increment", []() {
+		return [](std::size_t iterations) {
+			for (std::size_t i = 0; i < iterations; ++i) {
+				PerNodeSingleton<RequestCounter>::get_instance()->increment();
+			}
+		};
+	});
+}
+
+
+// ---------- Command ----------
+inline void register_command_benchmarks(BenchmarkSuite& suite) {
+
+	// Two kinds of command alternate, as on a remote with several slots
+	suite.add("command/virtual_execute", []() {
+		auto commands = std::make_shared<std::vector<std::unique_ptr<Command>>>();
+		commands->push_back(std::make_unique<LightOnCommand>(Light{}));
+		commands->push_back(std::make_unique<GarageDoorOpenCommand>(GarageDoor{}));
+		return [commands](std::size_t iterations) {
+			for (std::size_t i = 0; i < iterations; ++i) {
+				(*commands)[i & 1]->execute();
+			}
+		};
+	});
+
+	suite.add("command/fn_execute", []() {
+		auto light = std::make_shared<const Light>();
+		auto garage_door = std::make_shared<const GarageDoor>();
+		auto commands = std::make_shared<std::vector<CommandFn>>();
+		commands->push_back(make_command<&Light::turn_on>(light.get()));
+		commands->push_back(make_command<&GarageDoor::open>(garage_door.get()));
+		return [light, garage_door, commands](std::size_t iterations) {
+			for (std::size_t i = 0; i < iterations; ++i) {
+				(*commands)[i & 1].execute();
+			}
+		};
+	});
+
+	// Creating a command: heap allocation vs CommandFn's inline buffer
+	suite.add("command/virtual_create", []() {
+		return [](std::size_t iterations) {
+			const Light light;
+			for (std::size_t i = 0; i < iterations; ++i) {
+				const std::unique_ptr<Command> command = std::make_unique<LightOnCommand>(light);
+				do_not_optimize(command);
+			}
+		};
+	});
+
+	suite.add("command/fn_create", []() {
+		return [](std::size_t iterations) {
+			const Light light;
+			for (std::size_t i = 0; i < iterations; ++i) {
+				const CommandFn command = make_command<&Light::turn_on>(&light);
+				do_not_optimize(command);
+			}
+		};
+	});
+}
+
+
+// ---------- Adapter ----------
+inline void register_adapter_benchmarks(BenchmarkSuite& suite) {
+
+	suite.add("adapter/virtual", []() {
+		auto turkey = std::make_shared<CookedThanksgivingTurkeyClass>();
+		auto adapter = std::make_shared<TurkeyToDuckAdapterClass>(turkey.get());
+		return [turkey, adapter](std::size_t iterations) {
+			for (std::size_t i = 0; i < iterations; ++i) {
+				test_duck(static_cast<DuckClass*>(adapter.get()));
+			}
+		};
+	});
+
+	// The adapter is opaque to the optimizer and memory is clobbered every
+	// iteration, so the (inlined) calls and their print_enabled() checks
+	// cannot be hoisted out of the loop or deleted
+	suite.add("adapter/static", []() {
+		auto turkey = std::make_shared<WildTurkey>();
+		return [turkey](std::size_t iterations) {
+			for (std::size_t i = 0; i < iterations; ++i) {
+				const auto duck = adapt<DuckClass>(*turkey);
+				do_not_optimize(duck);
+				test_duck(duck);
+				clobber_memory();
+			}
+		};
+	});
+
+	const std::size_t record_count = 4096;
+	suite.add("adapter/convert_records/" + std::to_string(record_count), [record_count]() {
+		auto in = std::make_shared<std::vector<TurkeyFarmRecord>>(record_count);
+		auto out = std::make_shared<std::vector<DuckRecord>>(record_count);
+		for (std::size_t i = 0; i < record_count; ++i) {
+			(*in)[i] = TurkeyFarmRecord{ 30.0f + i % 7, 12.0f + i % 5, static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(i % 52) };
+		}
+		return [in, out](std::size_t iterations) {
+			for (std::size_t i = 0; i < iterations; ++i) {
+				convert_turkey_farm_records(*in, *out);
+				do_not_optimize(out->data());
+				clobber_memory();
+			}
+		};
+	}, record_count);
+}
+
+
+// ---------- Template Method ----------
+inline void register_template_method_benchmarks(BenchmarkSuite& suite) {
+
+	suite.add("template_method/virtual", []() {
+		auto drinks = std::make_shared<std::vector<std::unique_ptr<CaffeineDrink>>>();
+		drinks->push_back(std::make_unique<Tea>());
+		drinks->push_back(std::make_unique<Coffee>());
+		return [drinks](std::size_t iterations) {
+			for (std::size_t i = 0; i < iterations; ++i) {
+				(*drinks)[i & 1]->prepare_recipe();
+			}
+		};
+	});
+
+	suite.add("template_method/crtp", []() {
+		return [](std::size_t iterations) {
+			const TeaT tea;
+			const CoffeeT coffee;
+			for (std::size_t i = 0; i < iterations; ++i) {
+				if (i & 1) {
+					coffee.prepare_recipe();
+				} else {
+					tea.prepare_recipe();
+				}
+			}
+		};
+	});
+}
+
+
+// ---------- Facade (Least Knowledge) ----------
+inline void register_facade_benchmarks(BenchmarkSuite& suite) {
+
+	suite.add("facade/car_start", []() {
+		return [](std::size_t iterations) {
+			const Car car;
+			const Key key;
+			for (std::size_t i = 0; i < iterations; ++i) {
+				do_not_optimize(car);
+				car.start_car(key);
+				clobber_memory();
+			}
+		};
+	});
+
+	const std::size_t fleet_size = 1024;
+	suite.add("facade/fleet_start/" + std::to_string(fleet_size), [fleet_size]() {
+		auto fleet = std::make_shared<Fleet>();
+		for (std::size_t i = 0; i < fleet_size; ++i) {
+			fleet->add_car();
+		}
+		auto keys = std::make_shared<const std::vector<Key>>(fleet_size);
+		return [fleet, keys](std::size_t iterations) {
+			for (std::size_t i = 0; i < iterations; ++i) {
+				const std::size_t started = fleet->start_cars(*keys);
+				do_not_optimize(started);
+			}
+		};
+	}, fleet_size);
+
+	suite.add("facade/ecs_start/" + std::to_string(fleet_size), [fleet_size]() {
+		auto registry = std::make_shared<VehicleRegistry>();
+		for (std::size_t i = 0; i < fleet_size; ++i) {
+			const EcsCar car{ *registry, 25.0f };
+			car.store_key(Key{});
+		}
+		return [registry](std::size_t iterations) {
+			StartupSystems systems{ *registry };
+			for (std::size_t i = 0; i < iterations; ++i) {
+				systems.start_all_cars();
+			}
+		};
+	}, fleet_size);
+}
+
+
+// ---------- Suite ----------
+inline BenchmarkSuite make_pattern_benchmarks() {
+	BenchmarkSuite suite;
+	register_observer_benchmarks(suite);
+	register_strategy_benchmarks(suite);
+	register_decorator_benchmarks(suite);
+	register_factory_benchmarks(suite);
+	register_singleton_benchmarks(suite);
+	register_command_benchmarks(suite);
+	register_adapter_benchmarks(suite);
+	register_template_method_benchmarks(suite);
+	register_facade_benchmarks(suite);
+	return suite;
+}
+
+
+// ----------------- Example --------------------
+// A quick pass over every benchmark.  The Benchmarks/ program runs the same
+// suite with longer timings and can write JSON.
+inline void pattern_benchmarks() {
+	BenchmarkSuite suite = make_pattern_benchmarks();
+	suite.set_min_time(std::chrono::milliseconds{ 20 });
+	suite.set_repetitions(3);
+	write_benchmark_table(std::cout, suite.run());
+}
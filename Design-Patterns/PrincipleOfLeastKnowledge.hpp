@@ -1,5 +1,6 @@
 #pragma once
 #include "Print.hpp"
+#include "Trace.hpp"
 
 // Concept From: Head First Design Patterns
 // Example in C++ written by: Paul Burgess
@@ -37,7 +38,8 @@ class Car{
 
 public:
 	Car() = default;
-	void start_car(Key key) const{
+	void start_car(const Key& key) const{
+		TRACE_SPAN("Car::start_car");
 
 		Doors doors; // The methods from this object are legal to call since we are creating it.
 		bool key_is_on =  key.key_turned_to_on(); // This method is legal since its an object passed in as a parameter
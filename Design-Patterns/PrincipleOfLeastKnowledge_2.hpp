@@ -0,0 +1,161 @@
+#pragma once
+#include "Print.hpp"
+#include "Trace.hpp"
+#include "PrincipleOfLeastKnowledge.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Concept From: Head First Design Patterns
+// Example in C++ written by: Paul Burgess
+
+// Fleet Facade
+// Car::start_car() is a facade for one car: check the key, start the engine,
+// turn the dashboard on, lock the doors.  Starting thousands of cars that way
+// walks through every component of one car before moving to the next car.
+
+// The fleet is a facade over many cars.  It keeps each kind of component in
+// its own array (structure of arrays) and runs one phase at a time over the
+// whole fleet: all key checks, then all engine starts, then all dashboards,
+// then all door locks.  Each phase is a tight loop over one array.
+
+// The least-knowledge rules from PrincipleOfLeastKnowledge.hpp still hold:
+// the fleet only calls methods on its own components, on the keys passed in
+// as parameters, and on itself.
+
+
+// ------------------------- Example -------------------------
+// How many cars are in each state
+struct FleetStatus {
+	std::size_t m_engines_running = 0;
+	std::size_t m_dashboards_on = 0;
+	std::size_t m_doors_locked = 0;
+};
+
+class Fleet {
+
+public:
+	using CarId = std::size_t;
+
+	CarId add_car() {
+		m_engines.emplace_back();
+		m_doors.emplace_back();
+		m_engine_running.push_back(0);
+		m_dashboard_on.push_back(0);
+		m_doors_locked.push_back(0);
+		return m_engines.size() - 1;
+	}
+
+	std::size_t size() const {
+		return m_engines.size();
+	}
+
+	// keys[i] belongs to car i.  Returns the number of cars started.
+	std::size_t start_cars(const std::vector<Key>& keys) {
+		TRACE_SPAN("Fleet::start_cars");
+
+		const std::size_t count = keys.size() < size() ? keys.size() : size();
+
+		// Phase 1: every key (objects passed in as parameters)
+		std::vector<std::uint8_t> key_is_on(count);
+		for (CarId car = 0; car < count; ++car) {
+			key_is_on[car] = keys[car].key_turned_to_on() ? 1 : 0;
+		}
+
+		// Phase 2: every engine (components of this object)
+		std::size_t started = 0;
+		for (CarId car = 0; car < count; ++car) {
+			if (key_is_on[car]) {
+				m_engines[car].start();
+				m_engine_running[car] = 1;
+				++started;
+			}
+		}
+
+		// Phase 3: every dashboard (method of this object)
+		turn_dashboards_on(key_is_on);
+
+		// Phase 4: every set of doors (components of this object)
+		for (CarId car = 0; car < count; ++car) {
+			if (key_is_on[car]) {
+				m_doors[car].lock();
+				m_doors_locked[car] = 1;
+			}
+		}
+
+		return started;
+	}
+
+	bool is_running(CarId car) const {
+		return m_engine_running[car] != 0;
+	}
+
+	bool is_dashboard_on(CarId car) const {
+		return m_dashboard_on[car] != 0;
+	}
+
+	bool are_doors_locked(CarId car) const {
+		return m_doors_locked[car] != 0;
+	}
+
+	// One pass per state array
+	FleetStatus get_status() const {
+		FleetStatus status;
+		for (CarId car = 0; car < size(); ++car) {
+			status.m_engines_running += m_engine_running[car];
+		}
+		for (CarId car = 0; car < size(); ++car) {
+			status.m_dashboards_on += m_dashboard_on[car];
+		}
+		for (CarId car = 0; car < size(); ++car) {
+			status.m_doors_locked += m_doors_locked[car];
+		}
+		return status;
+	}
+
+private:
+	void turn_dashboards_on(const std::vector<std::uint8_t>& key_is_on) {
+		for (CarId car = 0; car < key_is_on.size(); ++car) {
+			if (key_is_on[car]) {
+				print("Turning dashboard on");
+				m_dashboard_on[car] = 1;
+			}
+		}
+	}
+
+	// One array per component kind, indexed by CarId
+	std::vector<Engine> m_engines;
+	std::vector<Doors> m_doors;
+	std::vector<std::uint8_t> m_engine_running;
+	std::vector<std::uint8_t> m_dashboard_on;
+	std::vector<std::uint8_t> m_doors_locked;
+};
+
+inline void principle_of_least_knowledge_2() {
+
+	// Small fleet with output on
+	Fleet fleet;
+	fleet.add_car();
+	fleet.add_car();
+	const std::vector<Key> keys(fleet.size());
+	print("Started " + std::to_string(fleet.start_cars(keys)) + " cars\n");
+
+	// Large fleet: one call starts every car
+	const std::size_t fleet_size = 100000;
+	Fleet large_fleet;
+	for (std::size_t i = 0; i < fleet_size; ++i) {
+		large_fleet.add_car();
+	}
+	const std::vector<Key> fleet_keys(fleet_size);
+
+	const bool was_printing = print_enabled();
+	print_enabled() = false;
+	const std::size_t started = large_fleet.start_cars(fleet_keys);
+	print_enabled() = was_printing;
+	print("Started " + std::to_string(started) + " of " + std::to_string(large_fleet.size()) + " cars in the large fleet");
+
+	const FleetStatus status = large_fleet.get_status();
+	print("Engines running: " + std::to_string(status.m_engines_running) + ", dashboards on: " + std::to_string(status.m_dashboards_on)
+		+ ", doors locked: " + std::to_string(status.m_doors_locked));
+}
@@ -0,0 +1,323 @@
+#pragma once
+#include "Print.hpp"
+#include "Trace.hpp"
+#include "PrincipleOfLeastKnowledge.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Concept From: Head First Design Patterns
+// Example in C++ written by: Paul Burgess
+
+// Component Storage (Entity-Component-System)
+// Car holds its Engine by value and creates Doors when it needs them.  With
+// many cars and many kinds of components, each car's data ends up in its own
+// place in memory.  Here a car is just an id (an "entity").  Every kind of
+// component lives in its own dense array, and "systems" walk those arrays
+// from start to end.
+
+// Code outside the store never sees any of this.  EcsCar keeps the same
+// start_car(key) call as Car, so callers still only talk to the car (Law of
+// Demeter).
+
+
+// ---------- New Components ----------
+class Dashboard {
+public:
+	void turn_on() {
+		m_is_on = true;
+		print("Turning dashboard on");
+	}
+	bool is_on() const {
+		return m_is_on;
+	}
+private:
+	bool m_is_on = false;
+};
+
+class FuelTank {
+public:
+	explicit FuelTank(float litres = 0.0f)
+		:m_litres{ litres } {
+	}
+	bool has_fuel() const {
+		return m_litres > 0.0f;
+	}
+	float get_litres() const {
+		return m_litres;
+	}
+private:
+	float m_litres;
+};
+
+
+// ---------- Component Store ----------
+// Dense array of one component type.  'sparse' maps an entity id to its
+// position in the dense array; removal moves the last component into the gap
+// so the array never has holes.
+using VehicleEntity = std::uint32_t;
+
+template <typename Component>
+class ComponentStore {
+
+public:
+	void add(VehicleEntity entity, Component component) {
+		if (m_sparse.size() <= entity) {
+			m_sparse.resize(entity + 1, npos);
+		}
+		if (m_sparse[entity] != npos) {
+			m_dense[m_sparse[entity]] = component;
+			return;
+		}
+		m_sparse[entity] = m_dense.size();
+		m_dense.push_back(component);
+		m_entities.push_back(entity);
+	}
+
+	void remove(VehicleEntity entity) {
+		if (!has(entity)) {
+			return;
+		}
+		const std::size_t index = m_sparse[entity];
+		const VehicleEntity moved = m_entities.back();
+		m_dense[index] = m_dense.back();
+		m_entities[index] = moved;
+		m_sparse[moved] = index;
+		m_dense.pop_back();
+		m_entities.pop_back();
+		m_sparse[entity] = npos;
+	}
+
+	bool has(VehicleEntity entity) const {
+		return entity < m_sparse.size() && m_sparse[entity] != npos;
+	}
+
+	// Throws std::out_of_range when the entity has no such component
+	Component& get(VehicleEntity entity) {
+		check(entity);
+		return m_dense[m_sparse[entity]];
+	}
+
+	const Component& get(VehicleEntity entity) const {
+		check(entity);
+		return m_dense[m_sparse[entity]];
+	}
+
+	std::size_t size() const {
+		return m_dense.size();
+	}
+
+	// Linear walk over the dense array: fn(entity, component)
+	template <typename Fn>
+	void for_each(Fn fn) {
+		for (std::size_t i = 0; i < m_dense.size(); ++i) {
+			fn(m_entities[i], m_dense[i]);
+		}
+	}
+
+private:
+	static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+	void check(VehicleEntity entity) const {
+		if (!has(entity)) {
+			throw std::out_of_range("ComponentStore::get: entity " + std::to_string(entity) + " has no such component");
+		}
+	}
+
+	std::vector<Component> m_dense;
+	std::vector<VehicleEntity> m_entities;
+	std::vector<std::size_t> m_sparse;
+};
+
+
+// ---------- Registry ----------
+// One store per component type
+template <typename... Components>
+class ComponentRegistry {
+
+public:
+	VehicleEntity create_entity() {
+		return m_next_entity++;
+	}
+
+	// Entity ids are handed out densely from 0, so arrays indexed by entity
+	// need this many slots
+	std::size_t entity_count() const {
+		return m_next_entity;
+	}
+
+	void destroy_entity(VehicleEntity entity) {
+		(store<Components>().remove(entity), ...);
+	}
+
+	template <typename Component>
+	ComponentStore<Component>& store() {
+		return std::get<ComponentStore<Component>>(m_stores);
+	}
+
+	template <typename Component>
+	const ComponentStore<Component>& store() const {
+		return std::get<ComponentStore<Component>>(m_stores);
+	}
+
+private:
+	VehicleEntity m_next_entity = 0;
+	std::tuple<ComponentStore<Components>...> m_stores;
+};
+
+// The vehicle model.  Adding a component type to it means adding it to this
+// list.  The per-vehicle operations live here, so the car facade only asks
+// the registry to do things and never reaches through it into a store.
+class VehicleRegistry : public ComponentRegistry<Engine, Doors, Key, Dashboard, FuelTank> {
+
+public:
+	VehicleEntity create_vehicle(float fuel_litres) {
+		const VehicleEntity entity = create_entity();
+		store<Engine>().add(entity, Engine{});
+		store<Doors>().add(entity, Doors{});
+		store<Dashboard>().add(entity, Dashboard{});
+		store<FuelTank>().add(entity, FuelTank{ fuel_litres });
+		return entity;
+	}
+
+	bool has_fuel(VehicleEntity entity) const {
+		const ComponentStore<FuelTank>& fuel_tanks = store<FuelTank>();
+		return !fuel_tanks.has(entity) || fuel_tanks.get(entity).has_fuel();
+	}
+
+	void start_engine(VehicleEntity entity) const {
+		store<Engine>().get(entity).start();
+	}
+
+	void turn_dashboard_on(VehicleEntity entity) {
+		store<Dashboard>().get(entity).turn_on();
+	}
+
+	void lock_doors(VehicleEntity entity) const {
+		store<Doors>().get(entity).lock();
+	}
+
+	void set_key(VehicleEntity entity, const Key& key) {
+		store<Key>().add(entity, key);
+	}
+};
+
+
+// ---------- Systems ----------
+// Each system walks one dense array and looks up the other components it
+// needs by entity.  start_all_cars() runs the same steps as Car::start_car()
+// for every car, one step at a time.
+class StartupSystems {
+
+public:
+	explicit StartupSystems(VehicleRegistry& registry)
+		:m_registry{ registry } {
+	}
+
+	// Marks the cars whose key is on and which have fuel
+	std::vector<std::uint8_t> check_keys() {
+		std::vector<std::uint8_t> ready(m_registry.entity_count(), 0);
+		m_registry.store<Key>().for_each([&](VehicleEntity entity, const Key& key) {
+			ready[entity] = key.key_turned_to_on() && m_registry.has_fuel(entity) ? 1 : 0;
+		});
+		return ready;
+	}
+
+	void start_engines(const std::vector<std::uint8_t>& ready) {
+		m_registry.store<Engine>().for_each([&](VehicleEntity entity, const Engine& engine) {
+			if (ready[entity]) {
+				engine.start();
+			}
+		});
+	}
+
+	void turn_dashboards_on(const std::vector<std::uint8_t>& ready) {
+		m_registry.store<Dashboard>().for_each([&](VehicleEntity entity, Dashboard& dashboard) {
+			if (ready[entity]) {
+				dashboard.turn_on();
+			}
+		});
+	}
+
+	void lock_doors(const std::vector<std::uint8_t>& ready) {
+		m_registry.store<Doors>().for_each([&](VehicleEntity entity, const Doors& doors) {
+			if (ready[entity]) {
+				doors.lock();
+			}
+		});
+	}
+
+	void start_all_cars() {
+		TRACE_SPAN("StartupSystems::start_all_cars");
+		const std::vector<std::uint8_t> ready = check_keys();
+		start_engines(ready);
+		turn_dashboards_on(ready);
+		lock_doors(ready);
+	}
+
+private:
+	VehicleRegistry& m_registry;
+};
+
+
+// ---------- Facade ----------
+// Same API as Car.  The components behind it are rows in the registry's
+// arrays instead of members.
+class EcsCar {
+
+public:
+	EcsCar(VehicleRegistry& registry, float fuel_litres)
+		:m_registry{ registry },
+		m_entity{ registry.create_vehicle(fuel_litres) } {
+	}
+
+	void start_car(const Key& key) const {
+		TRACE_SPAN("EcsCar::start_car");
+		if (key.key_turned_to_on() && m_registry.has_fuel(m_entity)) {
+			m_registry.start_engine(m_entity);
+			m_registry.turn_dashboard_on(m_entity);
+			m_registry.lock_doors(m_entity);
+		}
+	}
+
+	// Hands the car its key so the fleet-wide systems can start it
+	void store_key(const Key& key) const {
+		m_registry.set_key(m_entity, key);
+	}
+
+private:
+	VehicleRegistry& m_registry;
+	VehicleEntity m_entity;
+};
+
+
+inline void principle_of_least_knowledge_3() {
+
+	VehicleRegistry registry;
+
+	// One car, used exactly like Car
+	const EcsCar car{ registry, 40.0f };
+	const Key key;
+	car.start_car(key);
+
+	print("\n");
+
+	// Many cars, started by the systems one array at a time
+	std::vector<EcsCar> cars;
+	for (int i = 0; i < 3; ++i) {
+		cars.emplace_back(registry, i == 1 ? 0.0f : 25.0f); // the second one is out of fuel
+		cars.back().store_key(Key{});
+	}
+	StartupSystems systems{ registry };
+	systems.start_all_cars();
+
+	// Ids that were never created are rejected
+	try {
+		registry.start_engine(static_cast<VehicleEntity>(registry.entity_count()));
+	} catch (const std::out_of_range& error) {
+		print(error.what());
+	}
+}
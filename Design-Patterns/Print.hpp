@@ -1,7 +1,16 @@
 #pragma once
 #include <iostream>
 
+// Printing can be switched off (e.g. while benchmarking, so the timings
+// measure the pattern and not the console)
+inline bool& print_enabled() {
+	static bool enabled = true;
+	return enabled;
+}
+
 template <typename T>
 inline void print(T print_val) {
-	std::cout << print_val << std::endl;
+	if (print_enabled()) {
+		std::cout << print_val << std::endl;
+	}
 }
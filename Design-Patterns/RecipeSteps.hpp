@@ -0,0 +1,63 @@
+#pragma once
+#include "Print.hpp"
+#include "Trace.hpp"
+#include "TemplateMethod_1.hpp"
+
+// Concept From: Head First Design Patterns
+// Example in C++ written by: Paul Burgess
+
+// Recipe Steps
+// CaffeineDrink's public interface is prepare_recipe(), which runs every step
+// of the recipe in one call.  Schedulers that run the steps one at a time
+// (the pipeline in TemplateMethod_2.hpp, the step graph in
+// TemplateMethod_4.hpp) use this step-by-step interface instead.
+// RecipeStepsAdapter forwards every step to the drink's own: CaffeineDrink's
+// fixed steps, the subclass's brew() and add_condiments(), and the subclass's
+// customer_wants_condiments() hook (through wants_condiments()).  Any
+// CaffeineDrink works without changes.
+
+
+// ---------- Step Interface ----------
+class IRecipeSteps {
+public:
+	virtual ~IRecipeSteps() = default;
+	virtual void boil_water() const = 0;
+	virtual void brew() const = 0;
+	virtual void pour_in_cup() const = 0;
+	virtual bool customer_wants_condiments() const = 0;
+	virtual void add_condiments() const = 0;
+};
+
+
+// ---------- Adapter ----------
+// A friend of CaffeineDrink, so it can call the steps that prepare_recipe()
+// keeps private.  The drink must outlive the adapter.
+class RecipeStepsAdapter final : public IRecipeSteps {
+public:
+	explicit RecipeStepsAdapter(const CaffeineDrink& drink)
+		:m_drink{ &drink } {
+	}
+
+	void boil_water() const override {
+		m_drink->boil_water();
+	}
+
+	void brew() const override {
+		m_drink->brew();
+	}
+
+	void pour_in_cup() const override {
+		m_drink->pour_in_cup();
+	}
+
+	bool customer_wants_condiments() const override {
+		return m_drink->wants_condiments();
+	}
+
+	void add_condiments() const override {
+		m_drink->add_condiments();
+	}
+
+private:
+	const CaffeineDrink* m_drink;
+};
@@ -1,4 +1,5 @@
 #pragma once
+#include "Trace.hpp"
 #include <string>
 #include <iostream>
 
@@ -24,6 +25,7 @@ public:
 	// Create singleton object on first run.  On second run,
 	// return the existing instance of the object
 	static Singleton* get_instance(const std::string& name) {
+		TRACE_SPAN("Singleton::get_instance");
 		if (m_singleton == nullptr) {
 			m_singleton = new Singleton(name);
 		}
@@ -40,12 +42,10 @@ private:
 	}
 
 	std::string m_singleton_name;
-	static Singleton* m_singleton;
+	inline static Singleton* m_singleton = nullptr;
 
 };
 
-Singleton* Singleton::m_singleton = nullptr;
-
 inline void singleton_1() {
 
 	Singleton* my_singleton_object = Singleton::get_instance("Comet");
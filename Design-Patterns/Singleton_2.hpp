@@ -0,0 +1,304 @@
+#pragma once
+#include "Print.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+// Concept and example from: Refactor Guru Design Patterns
+// Example in C++ written by: Paul Burgess
+
+// Singleton Variants
+// A process-wide singleton that every thread writes to becomes a contention
+// point: the cache line holding its state "ping-pongs" between cores.  These
+// variants keep the get_instance() style of Singleton_1.hpp, but hand each
+// thread (or each NUMA node) its own instance.  An aggregation hook merges the
+// instances back together when a combined view is needed.
+
+// Both variants require T to provide:
+//   T()                        - default constructor
+//   void merge(const T& other) - folds 'other' into this instance (the hook)
+
+// Reads of another thread's instance during aggregation happen while that
+// thread may still be writing.  Keep hot fields in std::atomic (relaxed loads
+// and stores are as cheap as plain ones when there is a single writer).
+
+
+// Size used to pad instances so two instances never share a cache line
+constexpr std::size_t cache_line_size = 64;
+
+
+// ---------- Thread Local Singleton ----------
+// One instance per thread.  Threads that exit fold their state into a
+// "retired" instance so nothing is lost.
+template <typename T>
+class ThreadLocalSingleton {
+
+public:
+	ThreadLocalSingleton() = delete;
+
+	// Create this thread's instance on first run.  On later runs, return the
+	// existing instance for this thread (no locking after the first call)
+	static T* get_instance() {
+		thread_local Holder holder;
+		return &holder.m_slot.m_value;
+	}
+
+	// Aggregation hook: merge every live thread's instance plus the retired
+	// state into 'result'
+	static void aggregate(T& result) {
+		TRACE_SPAN("ThreadLocalSingleton::aggregate");
+		Registry& registry = get_registry();
+		std::lock_guard<std::mutex> lock{ registry.m_mutex };
+		result.merge(registry.m_retired.m_value);
+		for (const Slot* slot : registry.m_live) {
+			result.merge(slot->m_value);
+		}
+	}
+
+private:
+	struct alignas(cache_line_size) Slot {
+		T m_value;
+	};
+
+	struct Registry {
+		std::mutex m_mutex;
+		std::vector<Slot*> m_live;
+		Slot m_retired;
+	};
+
+	// Lives inside the thread_local above.  Registers on first use and retires
+	// itself when the thread exits.
+	struct Holder {
+		Holder() {
+			Registry& registry = get_registry();
+			std::lock_guard<std::mutex> lock{ registry.m_mutex };
+			registry.m_live.push_back(&m_slot);
+		}
+
+		~Holder() {
+			Registry& registry = get_registry();
+			std::lock_guard<std::mutex> lock{ registry.m_mutex };
+			registry.m_retired.m_value.merge(m_slot.m_value);
+			for (auto it = registry.m_live.begin(); it != registry.m_live.end(); ++it) {
+				if (*it == &m_slot) {
+					registry.m_live.erase(it);
+					break;
+				}
+			}
+		}
+
+		Slot m_slot;
+	};
+
+	static Registry& get_registry() {
+		static Registry registry;
+		return registry;
+	}
+};
+
+
+// ---------- NUMA Topology ----------
+// Minimal topology lookup (Linux sysfs).  Other platforms report a single
+// node, which makes PerNodeSingleton behave like a padded Singleton.
+class NumaTopology {
+
+public:
+	static const NumaTopology& get_instance() {
+		static const NumaTopology topology;
+		return topology;
+	}
+
+	std::size_t node_count() const {
+		return m_node_count;
+	}
+
+	std::size_t node_of_cpu(int cpu) const {
+		if (cpu < 0 || static_cast<std::size_t>(cpu) >= m_cpu_to_node.size()) {
+			return 0;
+		}
+		return std::min(m_cpu_to_node[cpu], m_node_count - 1);
+	}
+
+	// Node of the cpu the calling thread is running on right now
+	std::size_t current_node() const {
+#if defined(__linux__)
+		return node_of_cpu(sched_getcpu());
+#else
+		return 0;
+#endif
+	}
+
+private:
+	NumaTopology()
+		:m_node_count{ 1 } {
+#if defined(__linux__)
+		// Each node directory lists its cpus as ranges, e.g. "0-3,8-11"
+		for (std::size_t node = 0;; ++node) {
+			std::ifstream cpulist{ "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist" };
+			if (!cpulist) {
+				break;
+			}
+			m_node_count = node + 1;
+
+			std::string ranges;
+			std::getline(cpulist, ranges);
+			std::size_t pos = 0;
+			while (pos < ranges.size()) {
+				std::size_t comma = ranges.find(',', pos);
+				if (comma == std::string::npos) {
+					comma = ranges.size();
+				}
+				const std::string range = ranges.substr(pos, comma - pos);
+				const std::size_t dash = range.find('-');
+				const std::size_t first = std::stoul(range.substr(0, dash));
+				const std::size_t last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+				if (m_cpu_to_node.size() <= last) {
+					m_cpu_to_node.resize(last + 1, 0);
+				}
+				for (std::size_t cpu = first; cpu <= last; ++cpu) {
+					m_cpu_to_node[cpu] = node;
+				}
+				pos = comma + 1;
+			}
+		}
+#endif
+	}
+
+	std::size_t m_node_count;
+	std::vector<std::size_t> m_cpu_to_node;
+};
+
+
+// ---------- Per Node Singleton ----------
+// One instance per NUMA node.  Threads on the same node share an instance, so
+// T must be safe for concurrent use (e.g. atomic counters).  Each instance is
+// created by the first thread that asks for it, which places its memory on
+// that node under the usual first-touch policy.
+template <typename T>
+class PerNodeSingleton {
+
+public:
+	PerNodeSingleton() = delete;
+
+	// The calling thread's node is looked up once and then cached.  Threads
+	// are expected to be pinned; call refresh_node() after migrating one.
+	static T* get_instance() {
+		return get_instance_for_node(cached_node());
+	}
+
+	// Throws std::out_of_range for a node id the topology does not have
+	static T* get_instance_for_node(std::size_t node) {
+		Registry& registry = get_registry();
+		if (node >= registry.m_slots.size()) {
+			throw std::out_of_range("PerNodeSingleton: node " + std::to_string(node) + " of " + std::to_string(registry.m_slots.size()));
+		}
+		std::call_once(registry.m_created[node], [&registry, node]() {
+			registry.m_slots[node] = std::make_unique<Slot>();
+		});
+		return &registry.m_slots[node]->m_value;
+	}
+
+	static void refresh_node() {
+		cached_node() = NumaTopology::get_instance().current_node();
+	}
+
+	// Aggregation hook: merge every node's instance into 'result'
+	static void aggregate(T& result) {
+		TRACE_SPAN("PerNodeSingleton::aggregate");
+		Registry& registry = get_registry();
+		for (std::size_t node = 0; node < registry.m_slots.size(); ++node) {
+			get_instance_for_node(node);
+			result.merge(registry.m_slots[node]->m_value);
+		}
+	}
+
+private:
+	struct alignas(cache_line_size) Slot {
+		T m_value;
+	};
+
+	struct Registry {
+		Registry()
+			:m_slots(NumaTopology::get_instance().node_count()),
+			m_created(NumaTopology::get_instance().node_count()) {
+		}
+		std::vector<std::unique_ptr<Slot>> m_slots;
+		std::vector<std::once_flag> m_created;
+	};
+
+	static Registry& get_registry() {
+		static Registry registry;
+		return registry;
+	}
+
+	static std::size_t& cached_node() {
+		thread_local std::size_t node = NumaTopology::get_instance().current_node();
+		return node;
+	}
+};
+
+
+// ---------------- Example ----------------
+// A request counter that every worker bumps.  With a single shared counter,
+// each increment would fight over the same cache line.
+class RequestCounter {
+
+public:
+	void increment() {
+		m_count.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	long long get_count() const {
+		return m_count.load(std::memory_order_relaxed);
+	}
+
+	// Aggregation hook
+	void merge(const RequestCounter& other) {
+		m_count.fetch_add(other.get_count(), std::memory_order_relaxed);
+	}
+
+private:
+	std::atomic<long long> m_count{ 0 };
+};
+
+inline void singleton_2() {
+
+	const int thread_count = 4;
+	const int increments_per_thread = 1000000;
+
+	std::vector<std::thread> workers;
+	for (int i = 0; i < thread_count; ++i) {
+		workers.emplace_back([increments_per_thread]() {
+			RequestCounter* thread_counter = ThreadLocalSingleton<RequestCounter>::get_instance();
+			RequestCounter* node_counter = PerNodeSingleton<RequestCounter>::get_instance();
+			for (int j = 0; j < increments_per_thread; ++j) {
+				thread_counter->increment();
+				node_counter->increment();
+			}
+		});
+	}
+	for (auto& worker : workers) {
+		worker.join();
+	}
+
+	RequestCounter thread_total;
+	ThreadLocalSingleton<RequestCounter>::aggregate(thread_total);
+	print("Per-thread total: " + std::to_string(thread_total.get_count()));
+
+	RequestCounter node_total;
+	PerNodeSingleton<RequestCounter>::aggregate(node_total);
+	print("Per-node total: " + std::to_string(node_total.get_count()));
+	print("NUMA nodes: " + std::to_string(NumaTopology::get_instance().node_count()));
+}
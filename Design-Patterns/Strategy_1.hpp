@@ -1,6 +1,10 @@
 #pragma once
 #include "Print.hpp"
+#include "Trace.hpp"
+#include "WeaponKernels.hpp"
+#include <cstddef>
 #include <memory>
+#include <span>
 
 // Concept From: Head First Design Patterns
 // Example in C++ written by: Paul Burgess
@@ -11,6 +15,11 @@
 // The below example encapsulates weapon behaviors (algorithms) and makes them
 // easily applicable to various types of characters (interchangeable)
 
+// Besides use_weapon(), each weapon can work out its damage: damage_to() for
+// one target, and a batch use_weapon() for a whole span of targets in one
+// virtual call.  The batch version defaults to calling damage_to() per
+// target; the weapons below override it with SIMD kernels (WeaponKernels.hpp).
+
 
 // ---------- Weapon (algorithms) ----------
 class WeaponBehavior {
@@ -18,36 +27,93 @@ public:
 	WeaponBehavior() = default;
 	virtual ~WeaponBehavior() = default;
 	virtual void use_weapon() const = 0;
+
+	// Damage dealt to one target.  A weapon without a damage model deals none.
+	virtual float damage_to(const Target& target) const {
+		(void)target;
+		return 0.0f;
+	}
+
+	// damage[i] = damage dealt to targets[i].  Throws std::invalid_argument
+	// when damage is shorter than targets.
+	virtual void use_weapon(std::span<const Target> targets, std::span<float> damage) const {
+		check_damage_span(targets, damage);
+		for (std::size_t i = 0; i < targets.size(); ++i) {
+			damage[i] = damage_to(targets[i]);
+		}
+	}
 };
 
 class KnifeBehavior : public WeaponBehavior {
 	void use_weapon() const override {
 		print("Using a knife!");
 	}
+
+	float damage_to(const Target& target) const override {
+		return weapon_damage_scalar(m_profile, target);
+	}
+
+	void use_weapon(std::span<const Target> targets, std::span<float> damage) const override {
+		compute_weapon_damage(m_profile, targets, damage);
+	}
+
+	static constexpr WeaponProfile m_profile{ 12.0f, 1.0f, 1.5f, false };
 };
 
 class BowAndArrowBehavior : public WeaponBehavior {
 	void use_weapon() const override {
 		print("Aiming a bow!");
 	}
+
+	float damage_to(const Target& target) const override {
+		return weapon_damage_scalar(m_profile, target);
+	}
+
+	void use_weapon(std::span<const Target> targets, std::span<float> damage) const override {
+		compute_weapon_damage(m_profile, targets, damage);
+	}
+
+	static constexpr WeaponProfile m_profile{ 15.0f, 1.0f, 60.0f, true };
 };
 
 class AxeBehavior : public WeaponBehavior {
 	void use_weapon() const override {
 		print("Chopping an axe!");
 	}
+
+	float damage_to(const Target& target) const override {
+		return weapon_damage_scalar(m_profile, target);
+	}
+
+	void use_weapon(std::span<const Target> targets, std::span<float> damage) const override {
+		compute_weapon_damage(m_profile, targets, damage);
+	}
+
+	static constexpr WeaponProfile m_profile{ 30.0f, 0.5f, 2.0f, false };
 };
 
 class SwordBehavior : public WeaponBehavior {
 	void use_weapon() const override {
 		print("Swinging a sword!");
 	}
+
+	float damage_to(const Target& target) const override {
+		return weapon_damage_scalar(m_profile, target);
+	}
+
+	void use_weapon(std::span<const Target> targets, std::span<float> damage) const override {
+		compute_weapon_damage(m_profile, targets, damage);
+	}
+
+	static constexpr WeaponProfile m_profile{ 20.0f, 1.0f, 2.5f, false };
 };
 
 class NoWeapon : public WeaponBehavior {
 	void use_weapon() const override {
 		print("No weapon exists! Uh oh!");
 	}
+
+	// Keeps the default damage_to() and batch use_weapon(): no damage
 };
 
 
@@ -67,9 +133,15 @@ public:
 	}
 
 	void use_weapon() const {
+		TRACE_SPAN("Character::use_weapon");
 		m_weapon->use_weapon();
 	}
 
+	void use_weapon(std::span<const Target> targets, std::span<float> damage) const {
+		TRACE_SPAN("Character::use_weapon(batch)");
+		m_weapon->use_weapon(targets, damage);
+	}
+
 	virtual void display() const = 0;
 
 private:
@@ -1,4 +1,5 @@
 #pragma once
+#include "Trace.hpp"
 #include <iostream>
 #include <memory>
 
@@ -90,9 +91,11 @@ public:
 	virtual void display() const = 0;
 
 	virtual void perform_fly() const {
+		TRACE_SPAN("Duck::perform_fly");
 		m_fly_behavior_ptr->fly();
 	}
 	virtual void perform_quack() const {
+		TRACE_SPAN("Duck::perform_quack");
 		m_quack_behavior_ptr->quack();
 	}
 
@@ -0,0 +1,301 @@
+#pragma once
+#include "Print.hpp"
+#include "Trace.hpp"
+#include "AllocationHook.hpp"
+#include "Strategy_1.hpp"
+#include "Strategy_2.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Concept From: Head First Design Patterns
+// Example in C++ written by: Paul Burgess
+
+// Flyweight Strategies
+// In Strategy_1.hpp and Strategy_2.hpp every Character or Duck owns its own
+// heap-allocated behavior (a NoWeapon, a FlyWithWings, a Quack), even though
+// those behaviors have no state: every FlyWithWings is identical.  With
+// millions of entities that is millions of tiny allocations of the same
+// thing.
+
+// A FlyweightPool keeps one shared, immutable instance of each behavior and
+// hands out a 2-byte handle.  Entities store handles instead of owning
+// pointers, so a character is 4 bytes instead of a vtable, a unique_ptr and a
+// separate heap block.
+//   - get_shared<FlyWithWings>() returns the one instance of a stateless type
+//   - intern<EnchantedWeaponBehavior>(parameters) returns the one instance for
+//     that parameter set (the interning table), creating it the first time
+
+// The pool is filled during setup.  After that it is only read, so any
+// number of threads can use the behaviors at once.  Behaviors live as long as
+// the pool.
+
+
+// ---------- Flyweight Pool ----------
+template <typename Interface>
+class FlyweightPool {
+
+public:
+	using Handle = std::uint16_t;
+
+	// One shared instance per stateless behavior type
+	template <typename Behavior>
+	Handle get_shared() {
+		const std::type_index type{ typeid(Behavior) };
+		const auto found = m_shared.find(type);
+		if (found != m_shared.end()) {
+			return found->second;
+		}
+		const Handle handle = add(std::make_unique<const Behavior>());
+		m_shared.emplace(type, handle);
+		return handle;
+	}
+
+	// One shared instance per parameter set.  The behavior declares a nested
+	// Parameters type with operator== and hash(), and get_parameters().
+	template <typename Behavior>
+	Handle intern(const typename Behavior::Parameters& parameters) {
+		std::vector<Handle>& candidates = m_interned[InternKey{ std::type_index{ typeid(Behavior) }, parameters.hash() }];
+		for (const Handle handle : candidates) {
+			if (static_cast<const Behavior&>(get(handle)).get_parameters() == parameters) {
+				return handle;
+			}
+		}
+		const Handle handle = add(std::make_unique<const Behavior>(parameters));
+		candidates.push_back(handle);
+		return handle;
+	}
+
+	const Interface& get(Handle handle) const {
+		return *m_behaviors[handle];
+	}
+
+	std::size_t size() const {
+		return m_behaviors.size();
+	}
+
+private:
+	using InternKey = std::pair<std::type_index, std::size_t>;
+
+	Handle add(std::unique_ptr<const Interface> behavior) {
+		if (m_behaviors.size() > static_cast<std::size_t>(static_cast<Handle>(-1))) {
+			throw std::length_error("FlyweightPool: out of handles");
+		}
+		m_behaviors.push_back(std::move(behavior));
+		return static_cast<Handle>(m_behaviors.size() - 1);
+	}
+
+	std::vector<std::unique_ptr<const Interface>> m_behaviors;
+	std::unordered_map<std::type_index, Handle> m_shared;
+	std::map<InternKey, std::vector<Handle>> m_interned;
+};
+
+
+// ---------- Parameterized Weapon ----------
+// Has state, so it is shared per parameter set rather than per type
+class EnchantedWeaponBehavior : public WeaponBehavior {
+
+public:
+	struct Parameters {
+		std::string m_element;
+		int m_bonus = 0;
+
+		bool operator==(const Parameters& rhs) const = default;
+
+		std::size_t hash() const {
+			return std::hash<std::string>{}(m_element) * 31 + std::hash<int>{}(m_bonus);
+		}
+	};
+
+	explicit EnchantedWeaponBehavior(const Parameters& parameters)
+		:m_parameters{ parameters } {
+	}
+
+	void use_weapon() const override {
+		print("Swinging a " + m_parameters.m_element + " blade (+" + std::to_string(m_parameters.m_bonus) + ")!");
+	}
+
+	float damage_to(const Target& target) const override {
+		return weapon_damage_scalar(get_profile(), target);
+	}
+
+	void use_weapon(std::span<const Target> targets, std::span<float> damage) const override {
+		compute_weapon_damage(get_profile(), targets, damage);
+	}
+
+	const Parameters& get_parameters() const {
+		return m_parameters;
+	}
+
+private:
+	// A sword whose base damage grows with the bonus
+	WeaponProfile get_profile() const {
+		return WeaponProfile{ 20.0f + 4.0f * static_cast<float>(m_parameters.m_bonus), 1.0f, 2.5f, false };
+	}
+
+	const Parameters m_parameters;
+};
+
+
+// ---------- Flyweight Characters ----------
+using WeaponPool = FlyweightPool<WeaponBehavior>;
+
+enum class CharacterKind : std::uint8_t {
+	queen,
+	king,
+	troll,
+	knight
+};
+
+// 4 bytes: what kind of character, and which shared weapon it holds
+class FlyweightCharacter {
+
+public:
+	FlyweightCharacter(CharacterKind kind, WeaponPool::Handle weapon)
+		:m_kind{ kind },
+		m_weapon{ weapon } {
+	}
+
+	void set_weapon(WeaponPool::Handle weapon) {
+		m_weapon = weapon;
+	}
+
+	void use_weapon(const WeaponPool& weapons) const {
+		TRACE_SPAN("FlyweightCharacter::use_weapon");
+		weapons.get(m_weapon).use_weapon();
+	}
+
+	void display() const {
+		switch (m_kind) {
+		case CharacterKind::queen:
+			print("I am a queen!");
+			break;
+		case CharacterKind::king:
+			print("I am a king!");
+			break;
+		case CharacterKind::troll:
+			print("I am a troll!");
+			break;
+		case CharacterKind::knight:
+			print("I am knight!");
+			break;
+		}
+	}
+
+private:
+	CharacterKind m_kind;
+	WeaponPool::Handle m_weapon;
+};
+
+
+// ---------- Flyweight Ducks ----------
+struct DuckBehaviorPools {
+	FlyweightPool<IFlyBehavior> m_fly;
+	FlyweightPool<IQuackBehavior> m_quack;
+};
+
+// 4 bytes: one handle per behavior
+class FlyweightDuck {
+
+public:
+	FlyweightDuck(FlyweightPool<IFlyBehavior>::Handle fly, FlyweightPool<IQuackBehavior>::Handle quack)
+		:m_fly{ fly },
+		m_quack{ quack } {
+	}
+
+	void perform_fly(const DuckBehaviorPools& behaviors) const {
+		TRACE_SPAN("FlyweightDuck::perform_fly");
+		behaviors.m_fly.get(m_fly).fly();
+	}
+
+	void perform_quack(const DuckBehaviorPools& behaviors) const {
+		TRACE_SPAN("FlyweightDuck::perform_quack");
+		behaviors.m_quack.get(m_quack).quack();
+	}
+
+	void set_fly_behavior(FlyweightPool<IFlyBehavior>::Handle fly) {
+		m_fly = fly;
+	}
+
+	void set_quack_behavior(FlyweightPool<IQuackBehavior>::Handle quack) {
+		m_quack = quack;
+	}
+
+private:
+	FlyweightPool<IFlyBehavior>::Handle m_fly;
+	FlyweightPool<IQuackBehavior>::Handle m_quack;
+};
+
+
+// ---------------- Example ----------------
+inline void strategy_3() {
+
+	const std::size_t character_count = 1000000;
+	using Clock = std::chrono::steady_clock;
+
+	// Classic: every character owns its weapon
+	AllocationCounts before = get_thread_allocation_counts();
+	auto start = Clock::now();
+	std::vector<Queen> owning_characters(character_count);
+	for (std::size_t i = 0; i < character_count; ++i) {
+		if (i % 2 == 0) {
+			owning_characters[i].set_weapon(std::make_unique<SwordBehavior>());
+		}
+	}
+	const auto owning_time = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start);
+	const AllocationCounts owning = get_thread_allocation_counts() - before;
+
+	// Flyweight: characters hold handles into one pool
+	WeaponPool weapons;
+	const WeaponPool::Handle no_weapon = weapons.get_shared<NoWeapon>();
+	const WeaponPool::Handle sword = weapons.get_shared<SwordBehavior>();
+	before = get_thread_allocation_counts();
+	start = Clock::now();
+	std::vector<FlyweightCharacter> characters(character_count, FlyweightCharacter{ CharacterKind::queen, no_weapon });
+	for (std::size_t i = 0; i < character_count; ++i) {
+		if (i % 2 == 0) {
+			characters[i].set_weapon(sword);
+		}
+	}
+	const auto flyweight_time = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start);
+	const AllocationCounts flyweight = get_thread_allocation_counts() - before;
+
+	print(std::to_string(character_count) + " characters");
+	print("  Owning behaviors:    " + std::to_string(sizeof(Queen)) + " bytes each + " + format_allocation_count(owning.m_allocations)
+		+ " heap allocations, " + std::to_string(owning_time.count()) + " ms");
+	print("  Flyweight behaviors: " + std::to_string(sizeof(FlyweightCharacter)) + " bytes each + " + format_allocation_count(flyweight.m_allocations)
+		+ " heap allocations, " + std::to_string(flyweight_time.count()) + " ms, " + std::to_string(weapons.size()) + " weapons in the pool");
+	if (!allocation_hook_installed()) {
+		print("  (allocation counts need DESIGN_PATTERNS_ALLOCATION_HOOK, see AllocationHook.hpp)");
+	}
+
+	// Parameterized weapons are interned: equal parameters share one instance
+	const std::string elements[] = { "fire", "ice", "storm" };
+	for (std::size_t i = 0; i < character_count; ++i) {
+		const EnchantedWeaponBehavior::Parameters parameters{ elements[i % 3], static_cast<int>(i % 5) + 1 };
+		characters[i].set_weapon(weapons.intern<EnchantedWeaponBehavior>(parameters));
+	}
+	print("After enchanting every weapon: " + std::to_string(weapons.size()) + " weapons in the pool");
+	characters[0].display();
+	characters[0].use_weapon(weapons);
+	characters[4].use_weapon(weapons);
+
+	// Ducks share their fly and quack behaviors the same way
+	DuckBehaviorPools duck_behaviors;
+	FlyweightDuck rocket_duck{ duck_behaviors.m_fly.get_shared<RocketShipFly>(), duck_behaviors.m_quack.get_shared<Squeak>() };
+	FlyweightDuck silly_duck{ duck_behaviors.m_fly.get_shared<FlyWithWings>(), duck_behaviors.m_quack.get_shared<CantQuack>() };
+	rocket_duck.perform_fly(duck_behaviors);
+	rocket_duck.set_quack_behavior(duck_behaviors.m_quack.get_shared<Quack>());
+	rocket_duck.perform_quack(duck_behaviors);
+	silly_duck.perform_fly(duck_behaviors);
+}
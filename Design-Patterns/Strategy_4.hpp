@@ -0,0 +1,122 @@
+#pragma once
+#include "Print.hpp"
+#include "Trace.hpp"
+#include "Strategy_1.hpp"
+#include "WeaponKernels.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+// Concept From: Head First Design Patterns
+// Example in C++ written by: Paul Burgess
+
+// Batch Strategies
+// Calling use_weapon() once per target costs a virtual call per target, and
+// the compiler cannot vectorize across calls.  The batch overload
+// use_weapon(targets, damage) makes one virtual call for the whole span; the
+// weapon then runs a tight kernel over it (WeaponKernels.hpp), using AVX2 when
+// the CPU has it.  The strategy is still chosen per character at runtime;
+// only the granularity of the call changes.
+
+// The example checks that the scalar and AVX2 kernels agree, then times one
+// batch call against one call per target.
+
+
+// ---------- Targets ----------
+// Deterministic, so runs and kernels can be compared
+inline std::vector<Target> make_targets(std::size_t count, std::uint32_t seed = 1) {
+	std::vector<Target> targets(count);
+	std::uint32_t state = seed;
+	auto next = [&state]() {
+		state = state * 1664525u + 1013904223u;
+		return static_cast<float>(state >> 8) / static_cast<float>(1u << 24);
+	};
+	for (Target& target : targets) {
+		target.m_armor = next();
+		target.m_distance = next() * 80.0f;
+		target.m_health = 10.0f + next() * 90.0f;
+		target.m_weakness = 0.5f + next() * 1.5f;
+	}
+	return targets;
+}
+
+// One virtual call per target: the baseline the batch overload replaces
+inline void use_weapon_per_target(const Character& character, std::span<const Target> targets, std::span<float> damage) {
+	for (std::size_t i = 0; i < targets.size(); ++i) {
+		character.use_weapon(targets.subspan(i, 1), damage.subspan(i, 1));
+	}
+}
+
+
+// ---------------- Example ----------------
+inline void strategy_4() {
+
+	const std::size_t target_count = 4096;
+	const std::size_t repeats = 1000;
+	using Clock = std::chrono::steady_clock;
+
+	const std::vector<Target> targets = make_targets(target_count);
+	std::vector<float> damage(target_count);
+
+	print(std::string{ "Batch kernel: " } + get_weapon_kernel_name(active_weapon_kernel())
+		+ (cpu_supports_avx2() ? "" : " (CPU has no AVX2)"));
+
+	// Every weapon, scalar versus the active kernel
+	std::vector<std::unique_ptr<Character>> characters;
+	characters.push_back(std::make_unique<Queen>());
+	characters.push_back(std::make_unique<King>());
+	characters.push_back(std::make_unique<Troll>());
+	characters.push_back(std::make_unique<Knight>());
+	characters[0]->set_weapon(std::make_unique<KnifeBehavior>());
+	characters[1]->set_weapon(std::make_unique<BowAndArrowBehavior>());
+	characters[2]->set_weapon(std::make_unique<AxeBehavior>());
+	characters[3]->set_weapon(std::make_unique<SwordBehavior>());
+
+	const WeaponKernel best_kernel = active_weapon_kernel();
+	std::vector<float> scalar_damage(target_count);
+	std::size_t mismatches = 0;
+	for (const auto& character : characters) {
+		active_weapon_kernel() = WeaponKernel::scalar;
+		character->use_weapon(targets, scalar_damage);
+		active_weapon_kernel() = best_kernel;
+		character->use_weapon(targets, damage);
+		for (std::size_t i = 0; i < target_count; ++i) {
+			if (damage[i] != scalar_damage[i]) {
+				++mismatches;
+			}
+		}
+	}
+	print("Scalar and " + std::string{ get_weapon_kernel_name(best_kernel) } + " results differ for " + std::to_string(mismatches)
+		+ " of " + std::to_string(target_count * characters.size()) + " targets");
+
+	// One call per target versus one call per batch
+	const Character& knight = *characters[3];
+	auto start = Clock::now();
+	for (std::size_t r = 0; r < repeats; ++r) {
+		use_weapon_per_target(knight, targets, damage);
+	}
+	const double per_target_ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / static_cast<double>(repeats * target_count);
+
+	start = Clock::now();
+	for (std::size_t r = 0; r < repeats; ++r) {
+		knight.use_weapon(targets, damage);
+	}
+	const double batch_ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / static_cast<double>(repeats * target_count);
+
+	float total = 0.0f;
+	for (const float value : damage) {
+		total += value;
+	}
+	print(std::to_string(target_count) + " targets, sword: " + std::to_string(per_target_ns) + " ns per target one call each, "
+		+ std::to_string(batch_ns) + " ns per target in one batch call");
+	print("Total sword damage: " + std::to_string(std::lround(total)));
+
+	// The single-target strategy is unchanged
+	knight.display();
+	knight.use_weapon();
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "Print.hpp"
+#include "Trace.hpp"
 
 // Concept From: Head First Design Patterns
 // Example in C++ written by: Paul Burgess
@@ -13,6 +14,7 @@ class CaffeineDrink{
 public:
 	virtual ~CaffeineDrink() = default;
 	void prepare_recipe() const{
+		TRACE_SPAN("CaffeineDrink::prepare_recipe");
 		boil_water();
 		brew();
 		pour_in_cup();
@@ -21,7 +23,16 @@ public:
 			add_condiments();
 		}
 	}
+
+	// Asks the hook (for code that runs the steps itself)
+	bool wants_condiments() const {
+		return customer_wants_condiments();
+	}
 private:
+	// Runs the steps one at a time for the schedulers in TemplateMethod_2.hpp
+	// and TemplateMethod_4.hpp (see RecipeSteps.hpp)
+	friend class RecipeStepsAdapter;
+
 	void boil_water() const{
 		print("Boiling water");
 	}		
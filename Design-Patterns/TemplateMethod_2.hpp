@@ -0,0 +1,300 @@
+#pragma once
+#include "Print.hpp"
+#include "Trace.hpp"
+#include "RecipeSteps.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Concept From: Head First Design Patterns
+// Example in C++ written by: Paul Burgess
+
+// Pipelined Template Method
+// CaffeineDrink::prepare_recipe() runs all of its steps for one drink before
+// the next drink can start.  The pipeline runs each step of the template
+// method as its own stage, with its own worker thread(s) and a bounded queue
+// in front of it.  While one drink is brewing, the next one is already boiling
+// water, so independent orders overlap.
+
+// The steps and the hook are still the ones defined by CaffeineDrink and its
+// subclasses, reached through RecipeStepsAdapter (RecipeSteps.hpp); only the
+// scheduling changes.  A drink whose
+// customer_wants_condiments() hook returns false skips the condiment stage
+// and goes straight to the output, without waiting behind drinks that need it.
+
+
+// ---------- Bounded Queue ----------
+// Blocking queue between two stages.  push() waits while the queue is full
+// (back-pressure); pop() waits while it is empty and returns false once the
+// queue has been closed and drained.
+template <typename T>
+class BoundedQueue {
+
+public:
+	explicit BoundedQueue(std::size_t capacity)
+		:m_capacity{ capacity },
+		m_closed{ false } {
+	}
+
+	void push(T value) {
+		std::unique_lock<std::mutex> lock{ m_mutex };
+		m_not_full.wait(lock, [this]() {
+			return m_items.size() < m_capacity;
+		});
+		m_items.push_back(std::move(value));
+		m_not_empty.notify_one();
+	}
+
+	bool pop(T& value) {
+		std::unique_lock<std::mutex> lock{ m_mutex };
+		m_not_empty.wait(lock, [this]() {
+			return !m_items.empty() || m_closed;
+		});
+		if (m_items.empty()) {
+			return false;
+		}
+		value = std::move(m_items.front());
+		m_items.pop_front();
+		m_not_full.notify_one();
+		return true;
+	}
+
+	void close() {
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		m_closed = true;
+		m_not_empty.notify_all();
+	}
+
+private:
+	const std::size_t m_capacity;
+	bool m_closed;
+	std::deque<T> m_items;
+	std::mutex m_mutex;
+	std::condition_variable m_not_full;
+	std::condition_variable m_not_empty;
+};
+
+
+// ---------- Stage Metrics ----------
+struct StageMetrics {
+	std::string m_name;
+	std::size_t m_processed;
+	std::size_t m_skipped;
+	double m_throughput_per_second;
+	double m_average_latency_us; // queue wait + time spent in the step
+	double m_average_service_us; // time spent in the step only
+};
+
+
+// ---------- Pipeline ----------
+class RecipePipeline {
+
+public:
+	RecipePipeline(std::size_t queue_capacity = 256, std::size_t workers_per_stage = 1)
+		:m_start_time{ Clock::now() } {
+
+		// The same steps, in the same order, as prepare_recipe()
+		add_stage("boil_water", [](const IRecipeSteps& drink) {
+			drink.boil_water();
+		}, nullptr);
+		add_stage("brew", [](const IRecipeSteps& drink) {
+			drink.brew();
+		}, nullptr);
+		add_stage("pour_in_cup", [](const IRecipeSteps& drink) {
+			drink.pour_in_cup();
+		}, nullptr);
+		add_stage("add_condiments", [](const IRecipeSteps& drink) {
+			drink.add_condiments();
+		}, [](const IRecipeSteps& drink) {
+			return !drink.customer_wants_condiments();
+		});
+
+		for (std::size_t i = 0; i <= m_stages.size(); ++i) {
+			m_queues.push_back(std::make_unique<BoundedQueue<Order>>(queue_capacity));
+		}
+		for (std::size_t i = 0; i < m_stages.size(); ++i) {
+			m_stages[i]->m_active_workers = workers_per_stage;
+			for (std::size_t j = 0; j < workers_per_stage; ++j) {
+				m_workers.emplace_back(&RecipePipeline::run_stage, this, i);
+			}
+		}
+		m_workers.emplace_back(&RecipePipeline::run_output, this);
+	}
+
+	RecipePipeline(const RecipePipeline&) = delete;
+	RecipePipeline& operator=(const RecipePipeline&) = delete;
+
+	~RecipePipeline() {
+		finish();
+	}
+
+	// The drink must stay alive until finish() returns
+	void submit(const IRecipeSteps* drink) {
+		m_queues.front()->push(Order{ drink, Clock::now() });
+	}
+
+	// Lets every submitted order through the pipeline, then stops the workers
+	void finish() {
+		if (m_finished) {
+			return;
+		}
+		m_finished = true;
+		m_queues.front()->close();
+		for (auto& worker : m_workers) {
+			worker.join();
+		}
+		m_end_time = Clock::now();
+	}
+
+	std::size_t get_completed_count() const {
+		return m_completed.load(std::memory_order_relaxed);
+	}
+
+	std::vector<StageMetrics> get_stage_metrics() const {
+		const Clock::time_point end = m_finished ? m_end_time : Clock::now();
+		const double seconds = std::chrono::duration<double>(end - m_start_time).count();
+
+		std::vector<StageMetrics> metrics;
+		for (const auto& stage : m_stages) {
+			const std::size_t processed = stage->m_processed.load(std::memory_order_relaxed);
+			const double divisor = processed == 0 ? 1.0 : static_cast<double>(processed);
+			metrics.push_back(StageMetrics{
+				stage->m_name,
+				processed,
+				stage->m_skipped.load(std::memory_order_relaxed),
+				seconds > 0.0 ? processed / seconds : 0.0,
+				stage->m_latency_ns.load(std::memory_order_relaxed) / divisor / 1000.0,
+				stage->m_service_ns.load(std::memory_order_relaxed) / divisor / 1000.0
+			});
+		}
+		return metrics;
+	}
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	struct Order {
+		const IRecipeSteps* m_drink;
+		Clock::time_point m_enqueued;
+	};
+
+	struct Stage {
+		std::string m_name;
+		std::function<void(const IRecipeSteps&)> m_step;
+		std::function<bool(const IRecipeSteps&)> m_skip; // empty: never skipped
+		std::size_t m_active_workers = 0;
+		std::mutex m_workers_mutex;
+		std::atomic<std::size_t> m_processed{ 0 };
+		std::atomic<std::size_t> m_skipped{ 0 };
+		std::atomic<long long> m_latency_ns{ 0 };
+		std::atomic<long long> m_service_ns{ 0 };
+	};
+
+	void add_stage(const std::string& name, std::function<void(const IRecipeSteps&)> step, std::function<bool(const IRecipeSteps&)> skip) {
+		auto stage = std::make_unique<Stage>();
+		stage->m_name = name;
+		stage->m_step = std::move(step);
+		stage->m_skip = std::move(skip);
+		m_stages.push_back(std::move(stage));
+	}
+
+	// Sends an order to the next stage that wants it (or to the output)
+	void forward(std::size_t from_stage, Order order) {
+		std::size_t next = from_stage + 1;
+		while (next < m_stages.size() && m_stages[next]->m_skip && m_stages[next]->m_skip(*order.m_drink)) {
+			m_stages[next]->m_skipped.fetch_add(1, std::memory_order_relaxed);
+			++next;
+		}
+		order.m_enqueued = Clock::now();
+		m_queues[next]->push(order);
+	}
+
+	void run_stage(std::size_t index) {
+		Stage& stage = *m_stages[index];
+		Order order{};
+		while (m_queues[index]->pop(order)) {
+			const Clock::time_point started = Clock::now();
+			{
+				TRACE_SPAN("RecipePipeline::run_step");
+				stage.m_step(*order.m_drink);
+			}
+			const Clock::time_point done = Clock::now();
+
+			stage.m_processed.fetch_add(1, std::memory_order_relaxed);
+			stage.m_service_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(done - started).count(), std::memory_order_relaxed);
+			stage.m_latency_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(done - order.m_enqueued).count(), std::memory_order_relaxed);
+			forward(index, order);
+		}
+
+		// The last worker of a stage to leave closes the next queue.  Orders
+		// that skip ahead only ever jump over stages that are still running, so
+		// no later queue can be closed while something may still be pushed to it.
+		std::lock_guard<std::mutex> lock{ stage.m_workers_mutex };
+		if (--stage.m_active_workers == 0) {
+			m_queues[index + 1]->close();
+		}
+	}
+
+	void run_output() {
+		Order order{};
+		while (m_queues.back()->pop(order)) {
+			m_completed.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	std::vector<std::unique_ptr<Stage>> m_stages;
+	std::vector<std::unique_ptr<BoundedQueue<Order>>> m_queues;
+	std::vector<std::thread> m_workers;
+	std::atomic<std::size_t> m_completed{ 0 };
+	bool m_finished = false;
+	Clock::time_point m_start_time;
+	Clock::time_point m_end_time;
+};
+
+
+// ----------------- Example --------------------
+inline void template_method_2() {
+
+	const Tea tea_drink;
+	const Coffee coffee_drink;
+	const RecipeStepsAdapter tea{ tea_drink };
+	const RecipeStepsAdapter coffee{ coffee_drink };
+
+	// A few orders with output on (the steps of different drinks interleave)
+	{
+		RecipePipeline pipeline{ 4 };
+		pipeline.submit(&tea);
+		pipeline.submit(&coffee);
+		pipeline.submit(&tea);
+		pipeline.finish();
+	}
+
+	print("\n");
+
+	// A larger stream of orders with output off, to look at the metrics
+	const bool was_printing = print_enabled();
+	print_enabled() = false;
+	RecipePipeline pipeline{ 256, 2 };
+	for (int i = 0; i < 100000; ++i) {
+		pipeline.submit(i % 2 == 0 ? static_cast<const IRecipeSteps*>(&tea) : &coffee);
+	}
+	pipeline.finish();
+	print_enabled() = was_printing;
+
+	print("Completed orders: " + std::to_string(pipeline.get_completed_count()));
+	for (const StageMetrics& metrics : pipeline.get_stage_metrics()) {
+		print(metrics.m_name + ": processed " + std::to_string(metrics.m_processed)
+			+ ", skipped " + std::to_string(metrics.m_skipped)
+			+ ", " + std::to_string(static_cast<long long>(metrics.m_throughput_per_second)) + "/s"
+			+ ", latency " + std::to_string(metrics.m_average_latency_us) + " us"
+			+ ", service " + std::to_string(metrics.m_average_service_us) + " us");
+	}
+}
@@ -0,0 +1,215 @@
+#pragma once
+#include "Print.hpp"
+#include "Trace.hpp"
+#include "TemplateMethod_1.hpp"
+#include "BenchmarkHarness.hpp"
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Concept From: Head First Design Patterns
+// Example in C++ written by: Paul Burgess
+
+// Template Method with Static Polymorphism (CRTP)
+// CaffeineDrink::prepare_recipe() makes up to four virtual calls per drink,
+// including the customer_wants_condiments() hook.  With the "curiously
+// recurring template pattern" the parent class knows the concrete drink type
+// at compile time (it is the template argument), so each step is a direct call
+// that can be inlined.
+
+// Hooks work the same way.  If a subclass's hook is a constant (a static
+// constexpr function, like CoffeeT's), the condiment branch is removed at
+// compile time.  A hook that has to decide at runtime is still supported.
+
+// The trade-off: TeaT and CoffeeT no longer share a common base class, so they
+// cannot sit in the same container without type erasure.
+
+
+// -------------- Class with Algorithm Outline  --------------
+template <typename Derived>
+class CaffeineDrinkT {
+public:
+	void prepare_recipe() const {
+		TRACE_SPAN("CaffeineDrinkT::prepare_recipe");
+		boil_water();
+		derived().brew();
+		pour_in_cup();
+
+		if constexpr (has_constant_hook()) {
+			if constexpr (Derived::customer_wants_condiments()) {
+				derived().add_condiments();
+			}
+		} else {
+			if (derived().customer_wants_condiments()) {
+				derived().add_condiments();
+			}
+		}
+	}
+
+protected:
+	// Only subclasses can be created
+	CaffeineDrinkT() = default;
+
+	// hook (constant by default: condiments are always added)
+	static constexpr bool customer_wants_condiments() {
+		return true;
+	}
+
+private:
+	const Derived& derived() const {
+		return static_cast<const Derived&>(*this);
+	}
+
+	// True when Derived::customer_wants_condiments() can be evaluated at
+	// compile time
+	static constexpr bool has_constant_hook() {
+		return requires { std::bool_constant<Derived::customer_wants_condiments()>{}; };
+	}
+
+	void boil_water() const {
+		print("Boiling water");
+	}
+
+	void pour_in_cup() const {
+		print("Pouring into cup");
+	}
+};
+
+
+// ----- Subclass that overrides steps in the algorithm ------
+class TeaT : public CaffeineDrinkT<TeaT> {
+private:
+	friend class CaffeineDrinkT<TeaT>;
+
+	void brew() const {
+		print("Brewing the tea");
+	}
+	void add_condiments() const {
+		print("Adding lemon to tea");
+	}
+
+	// Decided not to implement the hook (so condiments are always added)
+};
+
+
+// ----- Subclass that overrides steps in the algorithm ------
+class CoffeeT : public CaffeineDrinkT<CoffeeT> {
+private:
+	friend class CaffeineDrinkT<CoffeeT>;
+
+	void brew() const {
+		print("Dripping coffee through filter");
+	}
+	void add_condiments() const {
+		print("Adding sugar and cream");
+	}
+
+	// hook is overridden here with a constant, so the condiment step is never
+	// compiled into CoffeeT::prepare_recipe()
+	static constexpr bool customer_wants_condiments() {
+		return false;
+	}
+};
+
+
+// ----- Subclass with a hook that is decided at runtime ------
+class CustomTeaT : public CaffeineDrinkT<CustomTeaT> {
+public:
+	explicit CustomTeaT(bool wants_condiments)
+		:m_wants_condiments{ wants_condiments } {
+	}
+private:
+	friend class CaffeineDrinkT<CustomTeaT>;
+
+	void brew() const {
+		print("Brewing a custom tea");
+	}
+	void add_condiments() const {
+		print("Adding honey to tea");
+	}
+	bool customer_wants_condiments() const {
+		return m_wants_condiments;
+	}
+
+	bool m_wants_condiments;
+};
+
+
+// ---------------- Benchmark ----------------
+// Calls prepare_recipe() 'count' times (alternating tea and coffee) with the
+// output switched off.  Returns nanoseconds for {virtual, CRTP}.
+// Both loops pass the drinks through do_not_optimize() and clobber memory
+// each iteration, so every call re-reads print_enabled() and neither loop can
+// be hoisted or removed; what is left is the cost of the calls themselves.
+struct TemplateMethodTimings {
+	long long m_virtual_ns;
+	long long m_crtp_ns;
+};
+
+inline TemplateMethodTimings benchmark_template_method(std::size_t count) {
+
+	const bool was_printing = print_enabled();
+	print_enabled() = false;
+	TemplateMethodTimings timings{};
+
+	// Virtual: the drinks are only known through the base class
+	std::vector<std::unique_ptr<CaffeineDrink>> drinks;
+	drinks.push_back(std::make_unique<Tea>());
+	drinks.push_back(std::make_unique<Coffee>());
+
+	auto start = std::chrono::steady_clock::now();
+	for (std::size_t i = 0; i < count; ++i) {
+		const CaffeineDrink& drink = *drinks[i & 1];
+		do_not_optimize(drink);
+		drink.prepare_recipe();
+		clobber_memory();
+	}
+	timings.m_virtual_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+	// CRTP: the concrete types are known
+	const TeaT tea;
+	const CoffeeT coffee;
+
+	start = std::chrono::steady_clock::now();
+	for (std::size_t i = 0; i < count; i += 2) {
+		do_not_optimize(tea);
+		tea.prepare_recipe();
+		clobber_memory();
+		do_not_optimize(coffee);
+		coffee.prepare_recipe();
+		clobber_memory();
+	}
+	timings.m_crtp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+	print_enabled() = was_printing;
+	return timings;
+}
+
+
+// ----------------- Example --------------------
+inline void template_method_3() {
+
+	const TeaT tea;
+	tea.prepare_recipe();
+
+	print("\n");
+
+	const CoffeeT coffee;
+	coffee.prepare_recipe();
+
+	print("\n");
+
+	const CustomTeaT custom_tea{ true };
+	custom_tea.prepare_recipe();
+
+	print("\n");
+
+	const std::size_t count = 100000000;
+	const TemplateMethodTimings timings = benchmark_template_method(count);
+	print("prepare_recipe() x " + std::to_string(count) + " (output off)");
+	print("  virtual: " + std::to_string(timings.m_virtual_ns / 1000000) + " ms");
+	print("  CRTP:    " + std::to_string(timings.m_crtp_ns / 1000000) + " ms");
+}
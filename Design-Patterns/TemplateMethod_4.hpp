@@ -0,0 +1,311 @@
+#pragma once
+#include "Print.hpp"
+#include "Trace.hpp"
+#include "RecipeSteps.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Concept From: Head First Design Patterns
+// Example in C++ written by: Paul Burgess
+
+// Template Method with a Step Graph
+// CaffeineDrink::prepare_recipe() runs its steps in one fixed line, even though
+// some of them do not depend on each other (the water can boil while the
+// condiments are being prepared).  Here the parent class still owns the
+// algorithm, but describes it as steps with dependencies.  A scheduler runs
+// every step as soon as the steps it depends on are done, and runs independent
+// steps at the same time on a task pool.
+
+// The steps are the existing Tea and Coffee steps (TemplateMethod_1.hpp),
+// reached through RecipeStepsAdapter (RecipeSteps.hpp).  The drink's own
+// customer_wants_condiments() hook decides whether the condiment steps run at
+// all, so a new drink that overrides it needs no changes here.  Each step is given a duration that
+// stands in for real work, so the overlap shows up in the timings.
+
+
+// ---------- Task Pool ----------
+// Fixed set of worker threads pulling tasks from one queue
+class TaskPool {
+
+public:
+	explicit TaskPool(std::size_t thread_count)
+		:m_stopping{ false } {
+		if (thread_count == 0) {
+			thread_count = 1;
+		}
+		for (std::size_t i = 0; i < thread_count; ++i) {
+			m_threads.emplace_back(&TaskPool::run_worker, this);
+		}
+	}
+
+	TaskPool(const TaskPool&) = delete;
+	TaskPool& operator=(const TaskPool&) = delete;
+
+	~TaskPool() {
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			m_stopping = true;
+		}
+		m_has_work.notify_all();
+		for (auto& thread : m_threads) {
+			thread.join();
+		}
+	}
+
+	void submit(std::function<void()> task) {
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			m_tasks.push_back(std::move(task));
+		}
+		m_has_work.notify_one();
+	}
+
+private:
+	void run_worker() {
+		for (;;) {
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock{ m_mutex };
+				m_has_work.wait(lock, [this]() {
+					return m_stopping || !m_tasks.empty();
+				});
+				if (m_tasks.empty()) {
+					return;
+				}
+				task = std::move(m_tasks.front());
+				m_tasks.pop_front();
+			}
+			task();
+		}
+	}
+
+	bool m_stopping;
+	std::deque<std::function<void()>> m_tasks;
+	std::mutex m_mutex;
+	std::condition_variable m_has_work;
+	std::vector<std::thread> m_threads;
+};
+
+
+// ---------- Step Graph ----------
+class StepGraph {
+
+public:
+	using StepId = std::size_t;
+
+	// Steps must be added after the steps they depend on, which also makes
+	// the order of add_step() calls a valid serial order.  Throws
+	// std::invalid_argument for a dependency on a step that does not exist yet.
+	StepId add_step(const std::string& name, std::function<void()> action, const std::vector<StepId>& depends_on = {}) {
+		const StepId id = m_steps.size();
+		for (const StepId dependency : depends_on) {
+			if (dependency >= id) {
+				throw std::invalid_argument("StepGraph::add_step: '" + name + "' depends on unknown step " + std::to_string(dependency));
+			}
+		}
+		m_steps.push_back(Step{ name, std::move(action), {}, depends_on.size() });
+		for (const StepId dependency : depends_on) {
+			m_steps[dependency].m_dependents.push_back(id);
+		}
+		return id;
+	}
+
+	// Runs the steps one after another (the classic template method)
+	void run_serial() const {
+		TRACE_SPAN("StepGraph::run_serial");
+		for (const Step& step : m_steps) {
+			step.m_action();
+		}
+	}
+
+	// Runs each step once all of its dependencies are done.  Blocks until
+	// every step has finished.
+	void run(TaskPool& pool) const {
+		TRACE_SPAN("StepGraph::run");
+		if (m_steps.empty()) {
+			return;
+		}
+
+		RunState state{ m_steps.size() };
+		for (StepId id = 0; id < m_steps.size(); ++id) {
+			state.m_remaining_dependencies[id].store(m_steps[id].m_dependency_count, std::memory_order_relaxed);
+		}
+		for (StepId id = 0; id < m_steps.size(); ++id) {
+			if (m_steps[id].m_dependency_count == 0) {
+				schedule(pool, state, id);
+			}
+		}
+
+		std::unique_lock<std::mutex> lock{ state.m_mutex };
+		state.m_all_done.wait(lock, [&state]() {
+			return state.m_steps_left == 0;
+		});
+	}
+
+private:
+	struct Step {
+		std::string m_name;
+		std::function<void()> m_action;
+		std::vector<StepId> m_dependents;
+		std::size_t m_dependency_count;
+	};
+
+	// Per-run bookkeeping, so one graph can be run many times
+	struct RunState {
+		explicit RunState(std::size_t step_count)
+			:m_remaining_dependencies(step_count),
+			m_steps_left{ step_count } {
+		}
+		std::vector<std::atomic<std::size_t>> m_remaining_dependencies;
+		std::size_t m_steps_left;
+		std::mutex m_mutex;
+		std::condition_variable m_all_done;
+	};
+
+	void schedule(TaskPool& pool, RunState& state, StepId id) const {
+		pool.submit([this, &pool, &state, id]() {
+			{
+				TRACE_SPAN("StepGraph::run_step");
+				m_steps[id].m_action();
+			}
+
+			// Release the dependents whose last dependency this was
+			for (const StepId dependent : m_steps[id].m_dependents) {
+				if (state.m_remaining_dependencies[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+					schedule(pool, state, dependent);
+				}
+			}
+
+			std::lock_guard<std::mutex> lock{ state.m_mutex };
+			if (--state.m_steps_left == 0) {
+				state.m_all_done.notify_all();
+			}
+		});
+	}
+
+	std::vector<Step> m_steps;
+};
+
+
+// -------------- Class with Algorithm Outline  --------------
+// How long each step takes (stands in for real work)
+struct StepDurations {
+	std::chrono::milliseconds m_boil_water{ 0 };
+	std::chrono::milliseconds m_brew{ 0 };
+	std::chrono::milliseconds m_prepare_condiments{ 0 };
+};
+
+// Schedules the steps of an existing drink.  The drink's steps must outlive
+// the ScheduledCaffeineDrink.
+class ScheduledCaffeineDrink {
+public:
+	ScheduledCaffeineDrink(const IRecipeSteps& steps, StepDurations durations)
+		:m_steps{ &steps },
+		m_durations{ durations } {
+	}
+
+	// The algorithm (still owned here):
+	//   boil_water ---------> brew -> pour_in_cup -> add_condiments
+	//   prepare_condiments ------------------------^
+	void prepare_recipe(TaskPool& pool) const {
+		build_recipe().run(pool);
+	}
+
+	void prepare_recipe_serial() const {
+		build_recipe().run_serial();
+	}
+
+private:
+	StepGraph build_recipe() const {
+		StepGraph recipe;
+		const auto boil = recipe.add_step("boil_water", [this]() {
+			simulate_work(m_durations.m_boil_water);
+			m_steps->boil_water();
+		});
+		const auto brewed = recipe.add_step("brew", [this]() {
+			simulate_work(m_durations.m_brew);
+			m_steps->brew();
+		}, { boil });
+		const auto poured = recipe.add_step("pour_in_cup", [this]() {
+			m_steps->pour_in_cup();
+		}, { brewed });
+
+		if (m_steps->customer_wants_condiments()) {
+			const auto prepared = recipe.add_step("prepare_condiments", [this]() {
+				simulate_work(m_durations.m_prepare_condiments);
+				print("Preparing condiments");
+			});
+			recipe.add_step("add_condiments", [this]() {
+				m_steps->add_condiments();
+			}, { poured, prepared });
+		}
+		return recipe;
+	}
+
+	static void simulate_work(std::chrono::milliseconds duration) {
+		std::this_thread::sleep_for(duration);
+	}
+
+	const IRecipeSteps* m_steps;
+	StepDurations m_durations;
+};
+
+
+// ----- Subclass that overrides the hook ------
+class PlainTea : public Tea {
+private:
+	// No lemon for this customer
+	bool customer_wants_condiments() const override {
+		return false;
+	}
+};
+
+
+// ----------------- Example --------------------
+inline void template_method_4() {
+
+	TaskPool pool{ 2 };
+	const Tea tea_drink;
+	const Coffee coffee_drink;
+	const RecipeStepsAdapter tea_steps{ tea_drink };
+	const RecipeStepsAdapter coffee_steps{ coffee_drink };
+	const ScheduledCaffeineDrink tea{ tea_steps, { std::chrono::milliseconds{ 30 }, std::chrono::milliseconds{ 10 }, std::chrono::milliseconds{ 25 } } };
+	const ScheduledCaffeineDrink coffee{ coffee_steps, { std::chrono::milliseconds{ 30 }, std::chrono::milliseconds{ 20 } } };
+
+	auto start = std::chrono::steady_clock::now();
+	tea.prepare_recipe_serial();
+	coffee.prepare_recipe_serial();
+	const auto serial_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+	print("Serial: " + std::to_string(serial_time.count()) + " ms\n");
+
+	start = std::chrono::steady_clock::now();
+	tea.prepare_recipe(pool);
+	coffee.prepare_recipe(pool);
+	const auto graph_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+	print("Step graph: " + std::to_string(graph_time.count()) + " ms\n");
+
+	// The graph follows the hook of a drink it knows nothing about
+	const PlainTea plain_tea_drink;
+	const RecipeStepsAdapter plain_tea_steps{ plain_tea_drink };
+	const ScheduledCaffeineDrink plain_tea{ plain_tea_steps, { std::chrono::milliseconds{ 30 }, std::chrono::milliseconds{ 10 }, std::chrono::milliseconds{ 25 } } };
+	plain_tea.prepare_recipe(pool);
+	print("");
+
+	// A step can only depend on steps that are already in the graph
+	StepGraph broken;
+	try {
+		broken.add_step("pour_in_cup", []() {}, { 3 });
+	} catch (const std::invalid_argument& error) {
+		print(error.what());
+	}
+}
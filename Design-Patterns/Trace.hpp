@@ -0,0 +1,241 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Example in C++ written by: Paul Burgess
+
+// Tracing Spans
+// TRACE_SPAN("Class::method") at the top of a function records how long the
+// call took.  The key method of every pattern example is marked this way
+// (notify_all_observers(), prepare_recipe(), get_cost(), press_button(), ...).
+
+// Tracing is switched on at compile time by defining DESIGN_PATTERNS_TRACE=1
+// (CMake option of the same name).  When it is off, TRACE_SPAN expands to
+// nothing, so the marked methods compile exactly as before.
+
+// When it is on, each thread writes its spans into its own fixed-size ring
+// buffer (no locks, no allocation after the first span on a thread).  Once the
+// ring is full the oldest spans are overwritten.  Timestamps come from the CPU
+// time stamp counter (rdtsc) where available and from steady_clock otherwise.
+// write_chrome_trace() writes the spans in the Chrome trace-event format,
+// which chrome://tracing and https://ui.perfetto.dev can open.
+
+// Span names must be string literals (only the pointer is stored).  Write or
+// clear the trace while the traced threads are idle; a ring that is being
+// written to during the dump can produce a torn span.
+
+
+#ifndef DESIGN_PATTERNS_TRACE
+#define DESIGN_PATTERNS_TRACE 0
+#endif
+
+// Spans kept per thread (a power of two)
+#ifndef DESIGN_PATTERNS_TRACE_CAPACITY
+#define DESIGN_PATTERNS_TRACE_CAPACITY 16384
+#endif
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#if DESIGN_PATTERNS_TRACE
+#define TRACE_SPAN(name) const TraceSpan TRACE_CONCAT(trace_span_, __LINE__){ name }
+#else
+#define TRACE_SPAN(name) static_cast<void>(0)
+#endif
+
+
+// ---------- Clock ----------
+inline std::uint64_t read_trace_clock() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+
+// ---------- Per-Thread Ring ----------
+struct TraceEvent {
+	const char* m_name;
+	std::uint64_t m_begin;
+	std::uint64_t m_end;
+};
+
+class TraceRing {
+
+public:
+	static constexpr std::size_t capacity = DESIGN_PATTERNS_TRACE_CAPACITY;
+	static_assert((capacity & (capacity - 1)) == 0, "DESIGN_PATTERNS_TRACE_CAPACITY must be a power of two");
+
+	explicit TraceRing(std::uint32_t thread_id)
+		:m_thread_id{ thread_id },
+		m_events{ std::make_unique<TraceEvent[]>(capacity) } {
+	}
+
+	// Only called by the owning thread
+	void record(const char* name, std::uint64_t begin, std::uint64_t end) {
+		const std::uint64_t written = m_written.load(std::memory_order_relaxed);
+		m_events[written & (capacity - 1)] = TraceEvent{ name, begin, end };
+		m_written.store(written + 1, std::memory_order_release);
+	}
+
+	// The spans still in the ring, oldest first
+	std::vector<TraceEvent> get_events() const {
+		const std::uint64_t written = m_written.load(std::memory_order_acquire);
+		const std::uint64_t first = written > capacity ? written - capacity : 0;
+		std::vector<TraceEvent> events;
+		events.reserve(static_cast<std::size_t>(written - first));
+		for (std::uint64_t i = first; i < written; ++i) {
+			events.push_back(m_events[i & (capacity - 1)]);
+		}
+		return events;
+	}
+
+	void clear() {
+		m_written.store(0, std::memory_order_release);
+	}
+
+	std::uint32_t get_thread_id() const {
+		return m_thread_id;
+	}
+
+private:
+	const std::uint32_t m_thread_id;
+	std::atomic<std::uint64_t> m_written{ 0 };
+	std::unique_ptr<TraceEvent[]> m_events;
+};
+
+
+// ---------- Registry ----------
+// Owns every thread's ring.  Rings outlive their threads so spans from
+// short-lived worker threads still make it into the dump.
+class TraceRegistry {
+
+public:
+	static TraceRegistry& get_instance() {
+		static TraceRegistry registry;
+		return registry;
+	}
+
+	TraceRing* create_ring() {
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		m_rings.push_back(std::make_unique<TraceRing>(static_cast<std::uint32_t>(m_rings.size() + 1)));
+		return m_rings.back().get();
+	}
+
+	// The ring of the calling thread (created on its first span)
+	static TraceRing& get_local_ring() {
+		thread_local TraceRing* ring = get_instance().create_ring();
+		return *ring;
+	}
+
+	void clear() {
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		for (const auto& ring : m_rings) {
+			ring->clear();
+		}
+	}
+
+	void write_chrome_trace(std::ostream& out) {
+		const double ns_per_tick = calibrate();
+
+		std::ostringstream json;
+		json.precision(3);
+		json << std::fixed;
+		json << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+		bool first = true;
+
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		for (const auto& ring : m_rings) {
+			for (const TraceEvent& event : ring->get_events()) {
+				// Spans recorded before the epoch was taken are clamped to it
+				const std::uint64_t begin = event.m_begin > m_epoch_ticks ? event.m_begin - m_epoch_ticks : 0;
+				const std::uint64_t duration = event.m_end > event.m_begin ? event.m_end - event.m_begin : 0;
+				json << (first ? "\n" : ",\n");
+				json << "{\"name\": \"" << event.m_name << "\", \"ph\": \"X\", \"pid\": 1"
+					<< ", \"tid\": " << ring->get_thread_id()
+					<< ", \"ts\": " << begin * ns_per_tick / 1000.0
+					<< ", \"dur\": " << duration * ns_per_tick / 1000.0 << "}";
+				first = false;
+			}
+		}
+		json << "\n]}\n";
+		out << json.str();
+	}
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	TraceRegistry()
+		:m_epoch_ticks{ read_trace_clock() },
+		m_epoch_time{ Clock::now() } {
+	}
+
+	// Nanoseconds per clock tick, measured against steady_clock over the life
+	// of the registry (waiting briefly if that has been too short to be
+	// accurate)
+	double calibrate() const {
+		const Clock::duration min_span = std::chrono::milliseconds{ 10 };
+		if (Clock::now() - m_epoch_time < min_span) {
+			std::this_thread::sleep_for(min_span);
+		}
+		const std::uint64_t ticks = read_trace_clock() - m_epoch_ticks;
+		const double ns = std::chrono::duration<double, std::nano>(Clock::now() - m_epoch_time).count();
+		return ticks == 0 ? 1.0 : ns / static_cast<double>(ticks);
+	}
+
+	const std::uint64_t m_epoch_ticks;
+	const Clock::time_point m_epoch_time;
+	std::mutex m_mutex;
+	std::vector<std::unique_ptr<TraceRing>> m_rings;
+};
+
+
+// ---------- Span ----------
+// Records [construction, destruction) into the calling thread's ring
+class TraceSpan {
+
+public:
+	explicit TraceSpan(const char* name)
+		:m_name{ name },
+		m_begin{ read_trace_clock() } {
+	}
+
+	TraceSpan(const TraceSpan&) = delete;
+	TraceSpan& operator=(const TraceSpan&) = delete;
+
+	~TraceSpan() {
+		TraceRegistry::get_local_ring().record(m_name, m_begin, read_trace_clock());
+	}
+
+private:
+	const char* m_name;
+	std::uint64_t m_begin;
+};
+
+
+// ---------- Output ----------
+inline void write_chrome_trace(std::ostream& out) {
+	TraceRegistry::get_instance().write_chrome_trace(out);
+}
+
+inline void clear_trace() {
+	TraceRegistry::get_instance().clear();
+}
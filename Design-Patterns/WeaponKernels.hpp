@@ -0,0 +1,194 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define DESIGN_PATTERNS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define DESIGN_PATTERNS_X86 0
+#endif
+
+// GCC and Clang compile the AVX2 kernel for AVX2 even when the rest of the
+// program targets baseline x86-64; MSVC allows the intrinsics anywhere
+#if DESIGN_PATTERNS_X86 && (defined(__GNUC__) || defined(__clang__))
+#define DESIGN_PATTERNS_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define DESIGN_PATTERNS_TARGET_AVX2
+#endif
+
+// Example in C++ written by: Paul Burgess
+
+// Weapon Damage Kernels
+// Batch damage for the weapon strategies in Strategy_1.hpp: one call works
+// out the damage against a whole span of targets.  Every weapon is described
+// by a WeaponProfile (base damage, how much armor reduces it, reach, and
+// whether damage falls off with distance), and all weapons share one kernel:
+//
+//     raw    = base * (1 - armor_factor * armor) * weakness
+//     raw   *= melee ? (distance <= reach) : max(0, 1 - distance / reach)
+//     damage = min(max(raw, 0), health)
+//
+// There are two versions of the kernel: a scalar loop and an AVX2 loop that
+// handles 8 targets per step.  The AVX2 one is used when the CPU supports
+// it (checked once at runtime), so one build runs everywhere.  Both do the
+// same operations in the same order without fused multiply-add, and the
+// AVX2 min/max take their operands in the order that matches std::min and
+// std::max (which differ from minps/maxps for signed zeros and NaN), so the
+// two give the same results bit for bit.
+
+
+// ---------- Data ----------
+// 16 bytes, so 8 targets are exactly four AVX registers
+struct Target {
+	float m_armor = 0.0f;     // 0 = none, 1 = full
+	float m_distance = 0.0f;  // meters
+	float m_health = 100.0f;  // damage is capped at the remaining health
+	float m_weakness = 1.0f;  // damage multiplier
+};
+static_assert(sizeof(Target) == 4 * sizeof(float), "The AVX2 kernel loads a Target as four packed floats");
+
+struct WeaponProfile {
+	float m_base_damage;
+	float m_armor_factor;  // 1 = armor fully applies, 0 = ignores armor
+	float m_reach;         // meters
+	bool m_ranged;         // ranged: damage falls off linearly to 0 at reach
+};
+
+
+// ---------- Batch Contract ----------
+// Every batch call (kernel or not) requires room for one result per target
+inline void check_damage_span(std::span<const Target> targets, std::span<float> damage) {
+	if (damage.size() < targets.size()) {
+		throw std::invalid_argument("weapon damage: damage span is smaller than targets span");
+	}
+}
+
+
+// ---------- Scalar Kernel ----------
+// std::max(a, b) is (a < b ? b : a) and std::min(a, b) is (b < a ? b : a)
+inline float weapon_damage_scalar(const WeaponProfile& profile, const Target& target) {
+	float raw = profile.m_base_damage * (1.0f - profile.m_armor_factor * target.m_armor);
+	raw = raw * target.m_weakness;
+	if (profile.m_ranged) {
+		raw = raw * std::max(0.0f, 1.0f - target.m_distance * (1.0f / profile.m_reach));
+	} else {
+		raw = target.m_distance <= profile.m_reach ? raw : 0.0f;
+	}
+	return std::min(std::max(raw, 0.0f), target.m_health);
+}
+
+inline void weapon_damage_scalar(const WeaponProfile& profile, const Target* targets, float* damage, std::size_t count) {
+	for (std::size_t i = 0; i < count; ++i) {
+		damage[i] = weapon_damage_scalar(profile, targets[i]);
+	}
+}
+
+
+// ---------- AVX2 Kernel ----------
+#if DESIGN_PATTERNS_X86
+
+// Loads 8 targets and transposes them into one register per field.  Targets
+// i..i+3 go in the low 128 bits and i+4..i+7 in the high 128 bits, so the
+// in-lane transpose leaves each field in target order.
+DESIGN_PATTERNS_TARGET_AVX2
+inline void load_targets_avx2(const Target* targets, __m256& armor, __m256& distance, __m256& health, __m256& weakness) {
+	const float* data = reinterpret_cast<const float*>(targets);
+	const __m256 t04 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(data + 0)), _mm_loadu_ps(data + 16), 1);
+	const __m256 t15 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(data + 4)), _mm_loadu_ps(data + 20), 1);
+	const __m256 t26 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(data + 8)), _mm_loadu_ps(data + 24), 1);
+	const __m256 t37 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(data + 12)), _mm_loadu_ps(data + 28), 1);
+
+	const __m256 low01 = _mm256_unpacklo_ps(t04, t15);   // a0 a1 d0 d1 (per lane)
+	const __m256 high01 = _mm256_unpackhi_ps(t04, t15);  // h0 h1 w0 w1
+	const __m256 low23 = _mm256_unpacklo_ps(t26, t37);
+	const __m256 high23 = _mm256_unpackhi_ps(t26, t37);
+
+	armor = _mm256_shuffle_ps(low01, low23, _MM_SHUFFLE(1, 0, 1, 0));
+	distance = _mm256_shuffle_ps(low01, low23, _MM_SHUFFLE(3, 2, 3, 2));
+	health = _mm256_shuffle_ps(high01, high23, _MM_SHUFFLE(1, 0, 1, 0));
+	weakness = _mm256_shuffle_ps(high01, high23, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+DESIGN_PATTERNS_TARGET_AVX2
+inline void weapon_damage_avx2(const WeaponProfile& profile, const Target* targets, float* damage, std::size_t count) {
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 base_damage = _mm256_set1_ps(profile.m_base_damage);
+	const __m256 armor_factor = _mm256_set1_ps(profile.m_armor_factor);
+	const __m256 reach = _mm256_set1_ps(profile.m_reach);
+	const __m256 inverse_reach = _mm256_set1_ps(1.0f / profile.m_reach);
+
+	// _mm256_max_ps(a, b) is (a > b ? a : b) and _mm256_min_ps(a, b) is
+	// (a < b ? a : b); the operands are ordered to match the scalar kernel
+	std::size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256 armor, distance, health, weakness;
+		load_targets_avx2(targets + i, armor, distance, health, weakness);
+
+		__m256 raw = _mm256_mul_ps(base_damage, _mm256_sub_ps(one, _mm256_mul_ps(armor_factor, armor)));
+		raw = _mm256_mul_ps(raw, weakness);
+		if (profile.m_ranged) {
+			raw = _mm256_mul_ps(raw, _mm256_max_ps(_mm256_sub_ps(one, _mm256_mul_ps(distance, inverse_reach)), zero));
+		} else {
+			raw = _mm256_and_ps(raw, _mm256_cmp_ps(distance, reach, _CMP_LE_OQ));
+		}
+		_mm256_storeu_ps(damage + i, _mm256_min_ps(health, _mm256_max_ps(zero, raw)));
+	}
+	weapon_damage_scalar(profile, targets + i, damage + i, count - i);
+}
+
+#endif
+
+
+// ---------- Runtime Dispatch ----------
+enum class WeaponKernel {
+	scalar,
+	avx2
+};
+
+inline bool cpu_supports_avx2() {
+#if DESIGN_PATTERNS_X86 && (defined(__GNUC__) || defined(__clang__))
+	return __builtin_cpu_supports("avx2");
+#elif DESIGN_PATTERNS_X86 && defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) {
+		return false;
+	}
+	__cpuid(info, 1);
+	const bool os_saves_avx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+	__cpuidex(info, 7, 0);
+	return os_saves_avx && (info[1] & (1 << 5)) != 0;
+#else
+	return false;
+#endif
+}
+
+// The kernel used by every batch call.  Starts as the best the CPU supports;
+// it can be set to scalar (e.g. to compare), but must not be raised above
+// what the CPU supports.
+inline WeaponKernel& active_weapon_kernel() {
+	static WeaponKernel kernel = cpu_supports_avx2() ? WeaponKernel::avx2 : WeaponKernel::scalar;
+	return kernel;
+}
+
+inline const char* get_weapon_kernel_name(WeaponKernel kernel) {
+	return kernel == WeaponKernel::avx2 ? "avx2" : "scalar";
+}
+
+inline void compute_weapon_damage(const WeaponProfile& profile, std::span<const Target> targets, std::span<float> damage) {
+	check_damage_span(targets, damage);
+#if DESIGN_PATTERNS_X86
+	if (active_weapon_kernel() == WeaponKernel::avx2) {
+		weapon_damage_avx2(profile, targets.data(), damage.data(), targets.size());
+		return;
+	}
+#endif
+	weapon_damage_scalar(profile, targets.data(), damage.data(), targets.size());
+}
@@ -1,25 +1,73 @@
 #include "Strategy_1.hpp"
 #include "Strategy_2.hpp"
+#include "Strategy_3.hpp"
+#include "Strategy_4.hpp"
 #include "Observer_1.hpp"
 #include "Observer_2.hpp"
+#include "Observer_3.hpp"
+#include "Observer_4.hpp"
+#include "Observer_5.hpp"
+#include "Observer_6.hpp"
+#include "Observer_7.hpp"
+#include "Observer_8.hpp"
+#include "Observer_9.hpp"
+#include "Observer_10.hpp"
 #include "Decorator_1.hpp"
 #include "Factory_1.hpp"
 #include "Factory_2.hpp"
 #include "Singleton_1.hpp"
+#include "Singleton_2.hpp"
+#include "Command.hpp"
+#include "Command_2.hpp"
+#include "Command_3.hpp"
+#include "Command_4.hpp"
+#include "Command_5.hpp"
 #include "Adapter.hpp"
+#include "Adapter_2.hpp"
+#include "Adapter_3.hpp"
 #include "PrincipleOfLeastKnowledge.hpp"
+#include "PrincipleOfLeastKnowledge_2.hpp"
+#include "PrincipleOfLeastKnowledge_3.hpp"
 #include "TemplateMethod_1.hpp"
+#include "TemplateMethod_2.hpp"
+#include "TemplateMethod_3.hpp"
+#include "TemplateMethod_4.hpp"
+#include "PatternBenchmarks.hpp"
 
 int main(){
 	//strategy_1();
 	//strategy_2();
+	//strategy_3();
+	//strategy_4();
 	//observer_1();
 	//observer_2();
+	//observer_3();
+	//observer_4();
+	//observer_5();
+	//observer_6();
+	//observer_7();
+	//observer_8();
+	//observer_9();
+	//observer_10();
 	//decorator_1();
 	//factory_1();
 	//factory_2();
 	//singleton_1();
+	//singleton_2();
+	//command_1();
+	//command_2();
+	//command_3();
+	//command_4();
+	//command_5();
 	//adapter_1();
+	//adapter_2();
+	//adapter_3();
 	//principle_of_least_knowledge_1();
+	//principle_of_least_knowledge_2();
+	//principle_of_least_knowledge_3();
 	template_method_1();
+	//template_method_2();
+	//template_method_3();
+	//template_method_4();
+	//pattern_benchmarks();
 }
@@ -0,0 +1,48 @@
+// Counts heap allocations for the check below.  Must come before any other
+// include; see AllocationHook.hpp.  Only this program replaces operator new.
+#define DESIGN_PATTERNS_ALLOCATION_HOOK
+#include "AllocationHook.hpp"
+#include "Observer_10.hpp"
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+// Example in C++ written by: Paul Burgess
+
+// Checks the claim of the real-time observer (Observer_10.hpp): once set up,
+// the notify loop of the raw-pointer subject makes no heap allocations.
+// Exits with status 1 if the steady-state loop allocates (or if the hook is
+// not installed, so the count would prove nothing).  Run by ctest as
+// real_time_no_allocations.
+
+int main() {
+
+	if (!allocation_hook_installed()) {
+		std::cerr << "Allocation hook is not installed\n";
+		return 1;
+	}
+
+	const std::size_t observer_capacity = 64;
+	SequenceWeatherDataRaw sensor;
+	WeatherDataSubjectRaw subject{ &sensor };
+	subject.set_observer_capacity(observer_capacity);
+
+	std::vector<std::unique_ptr<IObserverRaw>> observers;
+	observers.reserve(observer_capacity);
+	for (std::size_t i = 0; i < observer_capacity / 2; ++i) {
+		observers.push_back(std::make_unique<CurrentConditionsDisplayRaw>(&subject));
+		observers.push_back(std::make_unique<ControlLoopDisplayRaw>(&subject));
+	}
+
+	const RealTimeLoopResult result = run_real_time_loop(subject, sensor, 1000, 100000);
+	const AllocationCounts& allocations = result.m_steady_state_allocations;
+	std::cout << result.m_cycles << " cycles with " << observer_capacity << " observers: "
+		<< allocations.m_allocations << " allocations, " << allocations.m_deallocations << " deallocations in steady state\n";
+
+	if (allocations.m_allocations != 0 || allocations.m_deallocations != 0) {
+		std::cerr << "The steady-state notify loop allocated\n";
+		return 1;
+	}
+	return 0;
+}